@@ -0,0 +1,595 @@
+/** @file
+   Implementacja alokatora pamięci dla wielomianów
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "utils.h"
+
+/**
+ * Nagłówek bloku puli, poprzedzający pamięć zwracaną użytkownikowi.
+ */
+typedef struct BlockHeader {
+    uint16_t sizeClass; ///< klasa rozmiaru albo `LARGE_CLASS`
+    uint16_t flags; ///< znaczniki ustawiane przez właściciela bloku
+    _Atomic uint32_t refs; ///< liczba właścicieli bloku
+    _Atomic(void *) aux; ///< wskaźnik pomocniczy ustawiany przez właściciela bloku
+} BlockHeader;
+
+/**
+ * Klasa bloków alokowanych bezpośrednio przez `malloc`. Przed nagłówkiem
+ * takiego bloku zapisany jest jego rozmiar.
+ */
+#define LARGE_CLASS UINT16_MAX
+
+/**
+ * Rozmiar bloków (razem z nagłówkiem) największej klasy.
+ */
+#define POOL_MAX_CLASS_SIZE 4096
+
+/**
+ * Rozmiary bloków (razem z nagłówkiem) w kolejnych klasach.
+ * Kolejne rozmiary rosną mniej więcej półtorakrotnie, więc blok marnuje
+ * co najwyżej jedną trzecią pamięci.
+ */
+static const size_t CLASS_SIZES[] = {32, 48, 64, 96, 128, 192, 256, 384, 512,
+                                     768, 1024, 1536, 2048, 3072, POOL_MAX_CLASS_SIZE};
+
+/**
+ * Liczba klas rozmiarów.
+ */
+#define POOL_CLASSES (sizeof(CLASS_SIZES) / sizeof(CLASS_SIZES[0]))
+
+_Static_assert(POOL_MAX_BLOCK <= POOL_MAX_CLASS_SIZE, "POOL_MAX_BLOCK exceeds the largest size class");
+_Static_assert(POOL_SLAB_SIZE >= POOL_MAX_BLOCK, "POOL_SLAB_SIZE must fit the largest block");
+
+/**
+ * Wolny blok puli; wskaźnik na następny wolny blok leży zaraz za nagłówkiem.
+ */
+typedef struct FreeBlock {
+    BlockHeader header; ///< nagłówek bloku
+    struct FreeBlock *next; ///< następny wolny blok tej samej klasy
+} FreeBlock;
+
+/**
+ * Płyta, z której wycinane są bloki puli.
+ */
+typedef struct Slab {
+    struct Slab *next; ///< następna płyta na liście wszystkich płyt
+    max_align_t data[]; ///< pamięć płyty
+} Slab;
+
+/**
+ * Niewykorzystana końcówka płyty oddana przez kończący się wątek. Opis leży
+ * na początku samej końcówki.
+ */
+typedef struct SlabTail {
+    struct SlabTail *next; ///< następna oddana końcówka
+    unsigned char *end; ///< koniec końcówki
+} SlabTail;
+
+/**
+ * Fragment areny.
+ */
+struct ArenaChunk {
+    ArenaChunk *prev; ///< poprzedni fragment areny
+    size_t size; ///< rozmiar pamięci fragmentu w bajtach
+    size_t used; ///< liczba zajętych bajtów
+    max_align_t data[]; ///< pamięć fragmentu
+};
+
+/**
+ * Listy wolnych bloków bieżącego wątku dla kolejnych klas.
+ * Blok zwolniony w innym wątku niż przydzielony trafia na listę wątku
+ * zwalniającego; płyty należą do całego programu.
+ */
+static _Thread_local FreeBlock *freeLists[POOL_CLASSES];
+
+/**
+ * Listy wolnych bloków oddane przez `PoolShareFreeBlocks` innym wątkom. Wątek
+ * bez wolnych bloków danej klasy zabiera z listy część bloków, zanim sięgnie
+ * do płyty. Listy są zmieniane pod `slabsMutex`; bez blokady wolno tylko
+ * sprawdzić, czy lista jest pusta.
+ */
+static _Atomic(FreeBlock *) sharedLists[POOL_CLASSES];
+
+/**
+ * Początek niewykorzystanej części płyty bieżącego wątku.
+ */
+static _Thread_local unsigned char *slabCursor;
+
+/**
+ * Koniec płyty bieżącego wątku.
+ */
+static _Thread_local unsigned char *slabEnd;
+
+/**
+ * Lista wszystkich płyt, zwalnianych przez `AllocRelease`.
+ */
+static Slab *slabs;
+
+/**
+ * Końcówki płyt oddane przez kończące się wątki, z których wątki wycinają
+ * bloki, zanim zaalokują nową płytę. Każda ma co najmniej `POOL_MAX_CLASS_SIZE`
+ * bajtów.
+ */
+static SlabTail *slabTails;
+
+/**
+ * Chroni listy `slabs`, `slabTails` i `sharedLists`.
+ */
+static pthread_mutex_t slabsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Wierzchni fragment areny bieżącego wątku.
+ */
+static _Thread_local ArenaChunk *arenaTop;
+
+/**
+ * Zapasowy fragment areny o domyślnym rozmiarze, który zachowujemy po
+ * zwolnieniu, żeby nie alokować go przy każdym użyciu areny.
+ */
+static _Thread_local ArenaChunk *arenaSpare;
+
+/**
+ * Liczba zajętych bajtów areny bieżącego wątku.
+ */
+static _Thread_local size_t arenaInUse;
+
+/**
+ * Liczniki statystyk; zmieniane atomowo, bo alokują również wątki robocze.
+ */
+static struct {
+    atomic_size_t poolAllocs; ///< `AllocStats::poolAllocs`
+    atomic_size_t poolReuses; ///< `AllocStats::poolReuses`
+    atomic_size_t poolFrees; ///< `AllocStats::poolFrees`
+    atomic_size_t largeAllocs; ///< `AllocStats::largeAllocs`
+    atomic_size_t slabBytes; ///< `AllocStats::slabBytes`
+    atomic_size_t arenaAllocs; ///< `AllocStats::arenaAllocs`
+    atomic_size_t arenaBytes; ///< `AllocStats::arenaBytes`
+    atomic_size_t arenaPeak; ///< `AllocStats::arenaPeak`
+    atomic_size_t arenaResets; ///< `AllocStats::arenaResets`
+} stats;
+
+/**
+ * Zwiększa licznik statystyk @p counter o @p value.
+ * @param[in,out] counter : licznik
+ * @param[in] value : wartość
+ */
+static inline void StatsAdd(atomic_size_t *counter, size_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+/**
+ * Zwraca najmniejszą klasę, której bloki mieszczą @p size bajtów danych,
+ * albo `LARGE_CLASS`.
+ * @param[in] size : rozmiar w bajtach
+ * @return klasa rozmiaru
+ */
+static uint16_t SizeClass(size_t size) {
+    if (!POOL_ENABLED || size > POOL_MAX_BLOCK - sizeof(BlockHeader)) {
+        return LARGE_CLASS;
+    }
+
+    uint16_t result = 0;
+
+    while (CLASS_SIZES[result] - sizeof(BlockHeader) < size) {
+        ++result;
+    }
+
+    return result;
+}
+
+/**
+ * Zwraca liczbę bajtów danych mieszczących się w bloku o nagłówku @p header.
+ * @param[in] header : nagłówek bloku
+ * @return pojemność bloku
+ */
+static size_t BlockCapacity(const BlockHeader *header) {
+    if (header->sizeClass == LARGE_CLASS) {
+        return ((const size_t *)header)[-1];
+    }
+
+    return CLASS_SIZES[header->sizeClass] - sizeof(BlockHeader);
+}
+
+/**
+ * Dzieli niewykorzystaną część płyty bieżącego wątku na wolne bloki możliwie
+ * największych klas i dokłada je do list wolnych bloków wątku. Po jej
+ * wywołaniu wątek nie ma płyty.
+ */
+static void SlabFreeRest() {
+    if (slabCursor != NULL) {
+        for (unsigned c = POOL_CLASSES; c-- > 0;) {
+            while ((size_t)(slabEnd - slabCursor) >= CLASS_SIZES[c]) {
+                FreeBlock *block = (FreeBlock *)slabCursor;
+                block->header.sizeClass = (uint16_t)c;
+                block->next = freeLists[c];
+                freeLists[c] = block;
+                slabCursor += CLASS_SIZES[c];
+            }
+        }
+    }
+
+    slabCursor = slabEnd = NULL;
+}
+
+/**
+ * Wycina z płyty bieżącego wątku blok o rozmiarze @p size, biorąc w razie
+ * potrzeby końcówkę płyty oddaną przez inny wątek albo alokując nową płytę.
+ * @param[in] size : rozmiar bloku razem z nagłówkiem
+ * @return blok
+ */
+static BlockHeader *SlabCarve(size_t size) {
+    if (slabCursor == NULL || (size_t)(slabEnd - slabCursor) < size) {
+        SlabFreeRest();
+
+        pthread_mutex_lock(&slabsMutex);
+        SlabTail *tail = slabTails;
+
+        if (tail != NULL) {
+            slabTails = tail->next;
+        }
+
+        pthread_mutex_unlock(&slabsMutex);
+
+        if (tail != NULL) {
+            slabCursor = (unsigned char *)tail;
+            slabEnd = tail->end;
+        } else {
+            Slab *slab = malloc(sizeof(Slab) + POOL_SLAB_SIZE);
+            assert(slab != NULL);
+
+            pthread_mutex_lock(&slabsMutex);
+            slab->next = slabs;
+            slabs = slab;
+            pthread_mutex_unlock(&slabsMutex);
+
+            slabCursor = (unsigned char *)slab->data;
+            slabEnd = slabCursor + POOL_SLAB_SIZE;
+            StatsAdd(&stats.slabBytes, POOL_SLAB_SIZE);
+        }
+    }
+
+    BlockHeader *result = (BlockHeader *)slabCursor;
+    slabCursor += size;
+
+    return result;
+}
+
+/**
+ * Oddaje innym wątkom niewykorzystaną część płyty bieżącego wątku: dużą jako
+ * końcówkę płyty, a mniejszą jako wolne bloki.
+ */
+static void SlabShareRest() {
+    if (slabCursor != NULL && (size_t)(slabEnd - slabCursor) >= POOL_MAX_CLASS_SIZE) {
+        SlabTail *tail = (SlabTail *)slabCursor;
+        tail->end = slabEnd;
+
+        pthread_mutex_lock(&slabsMutex);
+        tail->next = slabTails;
+        slabTails = tail;
+        pthread_mutex_unlock(&slabsMutex);
+
+        slabCursor = slabEnd = NULL;
+    } else {
+        SlabFreeRest();
+    }
+}
+
+/**
+ * Zabiera z listy wolnych bloków klasy @p sizeClass oddanej przez inne wątki
+ * co najwyżej tyle bloków, ile mieści się w jednej płycie, i czyni je listą
+ * bieżącego wątku, której lista tej klasy musi być pusta. Dzięki temu jeden
+ * wątek nie zabiera wszystkich bloków, a pozostałe nie alokują nowych płyt.
+ * @param[in] sizeClass : klasa rozmiaru
+ * @return czy lista bieżącego wątku nie jest już pusta?
+ */
+static bool TakeSharedList(uint16_t sizeClass) {
+    if (atomic_load_explicit(&sharedLists[sizeClass], memory_order_relaxed) == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&slabsMutex);
+    FreeBlock *first = atomic_load_explicit(&sharedLists[sizeClass], memory_order_relaxed);
+
+    if (first != NULL) {
+        FreeBlock *last = first;
+
+        for (size_t count = POOL_SLAB_SIZE / CLASS_SIZES[sizeClass];
+             count > 1 && last->next != NULL; --count) {
+            last = last->next;
+        }
+
+        atomic_store_explicit(&sharedLists[sizeClass], last->next, memory_order_relaxed);
+        last->next = NULL;
+    }
+
+    pthread_mutex_unlock(&slabsMutex);
+    freeLists[sizeClass] = first;
+
+    return first != NULL;
+}
+
+void *PoolAlloc(size_t size) {
+    uint16_t sizeClass = SizeClass(size);
+    BlockHeader *header;
+
+    if (sizeClass == LARGE_CLASS) {
+        size_t *base = malloc(sizeof(size_t) + sizeof(BlockHeader) + size);
+        assert(base != NULL);
+        base[0] = size;
+        header = (BlockHeader *)(base + 1);
+        StatsAdd(&stats.largeAllocs, 1);
+    } else if (freeLists[sizeClass] != NULL || TakeSharedList(sizeClass)) {
+        FreeBlock *block = freeLists[sizeClass];
+        freeLists[sizeClass] = block->next;
+        header = &block->header;
+        StatsAdd(&stats.poolReuses, 1);
+    } else {
+        header = SlabCarve(CLASS_SIZES[sizeClass]);
+    }
+
+    header->sizeClass = sizeClass;
+    header->flags = 0;
+    atomic_init(&header->refs, 1);
+    atomic_init(&header->aux, NULL);
+    StatsAdd(&stats.poolAllocs, 1);
+
+    return header + 1;
+}
+
+void *PoolRealloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return PoolAlloc(size);
+    }
+
+    BlockHeader *header = (BlockHeader *)ptr - 1;
+    uint16_t sizeClass = SizeClass(size);
+    assert(!PoolIsShared(ptr));
+
+    if (sizeClass == header->sizeClass && sizeClass != LARGE_CLASS) {
+        return ptr;
+    } else if (sizeClass < header->sizeClass && header->sizeClass != LARGE_CLASS
+               && 2 * size >= BlockCapacity(header)) {
+        // Przenoszenie do mniejszej klasy nie opłaca się, gdy blok jest
+        // zapełniony co najmniej w połowie.
+        return ptr;
+    } else if (sizeClass == LARGE_CLASS && header->sizeClass == LARGE_CLASS) {
+        size_t *base = realloc((size_t *)header - 1, sizeof(size_t) + sizeof(BlockHeader) + size);
+        assert(base != NULL);
+        base[0] = size;
+
+        return (BlockHeader *)(base + 1) + 1;
+    }
+
+    size_t capacity = BlockCapacity(header);
+    void *result = PoolAlloc(size);
+    memcpy(result, ptr, (capacity < size) ? capacity : size);
+    PoolSetFlags(result, header->flags);
+    PoolPublishAux(result, PoolTakeAux(ptr));
+    PoolFree(ptr);
+
+    return result;
+}
+
+void PoolFree(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    BlockHeader *header = (BlockHeader *)ptr - 1;
+    StatsAdd(&stats.poolFrees, 1);
+
+    if (header->sizeClass == LARGE_CLASS) {
+        free((size_t *)header - 1);
+    } else {
+        FreeBlock *block = (FreeBlock *)header;
+        block->next = freeLists[header->sizeClass];
+        freeLists[header->sizeClass] = block;
+    }
+}
+
+void PoolShareFreeBlocks() {
+    for (unsigned c = 0; c < POOL_CLASSES; ++c) {
+        FreeBlock *first = freeLists[c];
+
+        if (first == NULL) {
+            continue;
+        }
+
+        // Po oddaniu lista wątku jest pusta, więc każdy blok przechodzimy tu
+        // co najwyżej raz od jego zwolnienia.
+        FreeBlock *last = first;
+
+        while (last->next != NULL) {
+            last = last->next;
+        }
+
+        pthread_mutex_lock(&slabsMutex);
+        last->next = atomic_load_explicit(&sharedLists[c], memory_order_relaxed);
+        atomic_store_explicit(&sharedLists[c], first, memory_order_relaxed);
+        pthread_mutex_unlock(&slabsMutex);
+
+        freeLists[c] = NULL;
+    }
+}
+
+void PoolRetain(void *ptr) {
+    BlockHeader *header = (BlockHeader *)ptr - 1;
+    atomic_fetch_add_explicit(&header->refs, 1, memory_order_relaxed);
+}
+
+bool PoolRelease(void *ptr) {
+    BlockHeader *header = (BlockHeader *)ptr - 1;
+
+    // Jedyny właściciel nie musi się z nikim synchronizować.
+    if (atomic_load_explicit(&header->refs, memory_order_acquire) == 1) {
+        return true;
+    }
+
+    return atomic_fetch_sub_explicit(&header->refs, 1, memory_order_acq_rel) == 1;
+}
+
+bool PoolIsShared(const void *ptr) {
+    const BlockHeader *header = (const BlockHeader *)ptr - 1;
+
+    return atomic_load_explicit(&header->refs, memory_order_acquire) > 1;
+}
+
+unsigned PoolGetFlags(const void *ptr) {
+    return ((const BlockHeader *)ptr - 1)->flags;
+}
+
+void PoolSetFlags(void *ptr, unsigned flags) {
+    ((BlockHeader *)ptr - 1)->flags = (uint16_t)flags;
+}
+
+void *PoolGetAux(const void *ptr) {
+    const BlockHeader *header = (const BlockHeader *)ptr - 1;
+
+    return atomic_load_explicit((_Atomic(void *) *)&header->aux, memory_order_acquire);
+}
+
+bool PoolPublishAux(void *ptr, void *aux) {
+    BlockHeader *header = (BlockHeader *)ptr - 1;
+    void *expected = NULL;
+
+    return atomic_compare_exchange_strong_explicit(&header->aux, &expected, aux,
+                                                   memory_order_acq_rel, memory_order_acquire);
+}
+
+void *PoolTakeAux(void *ptr) {
+    BlockHeader *header = (BlockHeader *)ptr - 1;
+
+    return atomic_exchange_explicit(&header->aux, NULL, memory_order_acquire);
+}
+
+void *ArenaAlloc(size_t size) {
+    size = (size + sizeof(max_align_t) - 1) / sizeof(max_align_t) * sizeof(max_align_t);
+
+    if (arenaTop == NULL || arenaTop->size - arenaTop->used < size) {
+        ArenaChunk *chunk;
+
+        if (size <= ARENA_CHUNK_SIZE && arenaSpare != NULL) {
+            chunk = arenaSpare;
+            arenaSpare = NULL;
+        } else {
+            size_t chunkSize = (size > ARENA_CHUNK_SIZE) ? size : ARENA_CHUNK_SIZE;
+            chunk = malloc(sizeof(ArenaChunk) + chunkSize);
+            assert(chunk != NULL);
+            chunk->size = chunkSize;
+        }
+
+        chunk->prev = arenaTop;
+        chunk->used = 0;
+        arenaTop = chunk;
+    }
+
+    void *result = (unsigned char *)arenaTop->data + arenaTop->used;
+    arenaTop->used += size;
+    arenaInUse += size;
+
+    StatsAdd(&stats.arenaAllocs, 1);
+    StatsAdd(&stats.arenaBytes, size);
+
+    size_t peak = atomic_load_explicit(&stats.arenaPeak, memory_order_relaxed);
+
+    while (peak < arenaInUse
+           && !atomic_compare_exchange_weak_explicit(&stats.arenaPeak, &peak, arenaInUse,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+    }
+
+    return result;
+}
+
+ArenaMark ArenaSave() {
+    return (ArenaMark) {.chunk = arenaTop, .used = arenaTop ? arenaTop->used : 0};
+}
+
+void ArenaRestore(ArenaMark mark) {
+    while (arenaTop != mark.chunk) {
+        ArenaChunk *chunk = arenaTop;
+        arenaTop = chunk->prev;
+        arenaInUse -= chunk->used;
+
+        // Bez puli (w testach) nie zostawiamy zapasu, żeby cmocka nie zgłosiła
+        // wycieku.
+        if (POOL_ENABLED && chunk->size == ARENA_CHUNK_SIZE && arenaSpare == NULL) {
+            arenaSpare = chunk;
+        } else {
+            free(chunk);
+        }
+    }
+
+    if (arenaTop != NULL) {
+        arenaInUse -= arenaTop->used - mark.used;
+        arenaTop->used = mark.used;
+    }
+}
+
+void ArenaReset() {
+    ArenaRestore((ArenaMark) {.chunk = NULL, .used = 0});
+    StatsAdd(&stats.arenaResets, 1);
+}
+
+/**
+ * Zwalnia pamięć areny bieżącego wątku razem z zapasowym fragmentem.
+ */
+static void ArenaRelease() {
+    ArenaRestore((ArenaMark) {.chunk = NULL, .used = 0});
+    free(arenaSpare);
+    arenaSpare = NULL;
+}
+
+void AllocThreadRelease() {
+    SlabShareRest();
+    PoolShareFreeBlocks();
+    ArenaRelease();
+}
+
+void AllocRelease() {
+    ArenaRelease();
+
+    pthread_mutex_lock(&slabsMutex);
+
+    while (slabs != NULL) {
+        Slab *slab = slabs;
+        slabs = slab->next;
+        free(slab);
+    }
+
+    slabTails = NULL;
+    pthread_mutex_unlock(&slabsMutex);
+
+    memset(freeLists, 0, sizeof(freeLists));
+    slabCursor = slabEnd = NULL;
+
+    for (unsigned c = 0; c < POOL_CLASSES; ++c) {
+        atomic_store_explicit(&sharedLists[c], NULL, memory_order_relaxed);
+    }
+}
+
+AllocStats AllocGetStats() {
+    return (AllocStats) {
+        .poolAllocs = atomic_load(&stats.poolAllocs),
+        .poolReuses = atomic_load(&stats.poolReuses),
+        .poolFrees = atomic_load(&stats.poolFrees),
+        .largeAllocs = atomic_load(&stats.largeAllocs),
+        .slabBytes = atomic_load(&stats.slabBytes),
+        .arenaAllocs = atomic_load(&stats.arenaAllocs),
+        .arenaBytes = atomic_load(&stats.arenaBytes),
+        .arenaPeak = atomic_load(&stats.arenaPeak),
+        .arenaResets = atomic_load(&stats.arenaResets)
+    };
+}
@@ -0,0 +1,230 @@
+/** @file
+   Interfejs alokatora pamięci dla wielomianów
+
+   Alokator składa się z dwóch części:
+   - puli bloków z listami wolnych bloków dla klas rozmiarów, z której
+     pochodzą tablice jednomianów i inne małe obiekty o dowolnym czasie życia;
+     bloki puli mają liczniki referencji, dzięki którym wielomiany mogą
+     współdzielić tablice jednomianów,
+   - areny, z której przydzielana jest pamięć tymczasowa; arenę zwalnia się
+     w całości do zapamiętanego wcześniej znacznika albo do zera.
+
+   W testach jednostkowych pula przekazuje każdą alokację do `malloc`, a arena
+   nie zachowuje zwolnionych fragmentów, żeby cmocka mogła śledzić wycieki.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Czy pula korzysta z list wolnych bloków. W testach jednostkowych każdy blok
+ * jest osobno alokowany przez `malloc`.
+ */
+#ifndef POOL_ENABLED
+#ifdef UNIT_TESTING
+#define POOL_ENABLED 0
+#else
+#define POOL_ENABLED 1
+#endif
+#endif
+
+/**
+ * Rozmiar (w bajtach) największego bloku obsługiwanego przez listy wolnych
+ * bloków. Większe bloki są alokowane bezpośrednio przez `malloc`.
+ */
+#ifndef POOL_MAX_BLOCK
+#define POOL_MAX_BLOCK 4096
+#endif
+
+/**
+ * Rozmiar (w bajtach) płyty, z której wycinane są bloki puli.
+ */
+#ifndef POOL_SLAB_SIZE
+#define POOL_SLAB_SIZE (1 << 16)
+#endif
+
+/**
+ * Domyślny rozmiar (w bajtach) fragmentu areny.
+ */
+#ifndef ARENA_CHUNK_SIZE
+#define ARENA_CHUNK_SIZE (1 << 16)
+#endif
+
+typedef struct ArenaChunk ArenaChunk;
+
+/**
+ * Znacznik stanu areny, do którego można ją później zwolnić.
+ */
+typedef struct ArenaMark {
+    ArenaChunk *chunk; ///< wierzchni fragment areny w chwili zapamiętania
+    size_t used; ///< liczba zajętych bajtów tego fragmentu
+} ArenaMark;
+
+/**
+ * Statystyki alokatora od początku działania programu.
+ */
+typedef struct AllocStats {
+    size_t poolAllocs; ///< liczba bloków przydzielonych z puli
+    size_t poolReuses; ///< liczba bloków wziętych z list wolnych bloków
+    size_t poolFrees; ///< liczba bloków zwróconych do puli
+    size_t largeAllocs; ///< liczba bloków zaalokowanych przez `malloc`
+    size_t slabBytes; ///< łączny rozmiar zaalokowanych płyt
+    size_t arenaAllocs; ///< liczba alokacji z areny
+    size_t arenaBytes; ///< łączny rozmiar alokacji z areny
+    size_t arenaPeak; ///< największa zajętość areny w bajtach
+    size_t arenaResets; ///< liczba wyzerowań areny
+} AllocStats;
+
+/**
+ * Przydziela z puli blok o rozmiarze co najmniej @p size bajtów, wyrównany
+ * do 8 bajtów.
+ * Wywłaszcza program w przypadku niepowodzenia alokacji.
+ * @param[in] size : rozmiar w bajtach
+ * @return wskaźnik na blok
+ */
+void *PoolAlloc(size_t size);
+
+/**
+ * Zmienia rozmiar bloku @p ptr przydzielonego z puli na @p size bajtów,
+ * zachowując zawartość. Blok zostaje na miejscu, jeśli nowy rozmiar należy
+ * do tej samej klasy albo jeśli blok jest zmniejszany i nowy rozmiar to co
+ * najmniej połowa jego pojemności.
+ * @param[in] ptr : blok z puli albo NULL
+ * @param[in] size : nowy rozmiar w bajtach
+ * @return wskaźnik na blok o nowym rozmiarze
+ */
+void *PoolRealloc(void *ptr, size_t size);
+
+/**
+ * Zwraca do puli blok @p ptr.
+ * @param[in] ptr : blok z puli albo NULL
+ */
+void PoolFree(void *ptr);
+
+/**
+ * Oddaje listy wolnych bloków bieżącego wątku innym wątkom, które zabiorą je,
+ * zanim zaczną wycinać bloki z nowych płyt. Woła ją wątek zwalniający bloki
+ * przydzielone przez inne wątki, żeby pamięć wracała do wątków, które ją
+ * przydzielają.
+ */
+void PoolShareFreeBlocks();
+
+/**
+ * Dodaje właściciela bloku @p ptr z puli. Świeżo przydzielony blok ma jednego
+ * właściciela.
+ * @param[in] ptr : blok z puli
+ */
+void PoolRetain(void *ptr);
+
+/**
+ * Usuwa właściciela bloku @p ptr z puli. Jeśli był to ostatni właściciel,
+ * wywołujący powinien zwolnić zawartość bloku i sam blok przez `PoolFree`.
+ * @param[in] ptr : blok z puli
+ * @return czy był to ostatni właściciel bloku?
+ */
+bool PoolRelease(void *ptr);
+
+/**
+ * Sprawdza, czy blok @p ptr z puli ma więcej niż jednego właściciela.
+ * Współdzielonego bloku nie wolno modyfikować ani zmieniać jego rozmiaru.
+ * @param[in] ptr : blok z puli
+ * @return czy blok jest współdzielony?
+ */
+bool PoolIsShared(const void *ptr);
+
+/**
+ * Zwraca znaczniki bloku @p ptr z puli. Świeżo przydzielony blok nie ma
+ * ustawionych znaczników, a `PoolRealloc` je zachowuje.
+ * @param[in] ptr : blok z puli
+ * @return znaczniki (16 bitów)
+ */
+unsigned PoolGetFlags(const void *ptr);
+
+/**
+ * Ustawia znaczniki bloku @p ptr z puli.
+ * @param[in] ptr : blok z puli
+ * @param[in] flags : znaczniki (16 bitów)
+ */
+void PoolSetFlags(void *ptr, unsigned flags);
+
+/**
+ * Zwraca wskaźnik pomocniczy bloku @p ptr z puli, pod którym właściciel może
+ * przechowywać dane wyliczone z zawartości bloku. Świeżo przydzielony blok ma
+ * pusty wskaźnik pomocniczy, a `PoolRealloc` go zachowuje.
+ * @param[in] ptr : blok z puli
+ * @return wskaźnik pomocniczy albo NULL
+ */
+void *PoolGetAux(const void *ptr);
+
+/**
+ * Ustawia wskaźnik pomocniczy bloku @p ptr z puli, jeśli nie był ustawiony.
+ * Wiele wątków współdzielących blok może próbować go ustawić jednocześnie;
+ * udaje się to dokładnie jednemu z nich.
+ * @param[in] ptr : blok z puli
+ * @param[in] aux : wskaźnik pomocniczy
+ * @return czy wskaźnik został ustawiony?
+ */
+bool PoolPublishAux(void *ptr, void *aux);
+
+/**
+ * Zeruje wskaźnik pomocniczy bloku @p ptr z puli. Wołana przez jedynego
+ * właściciela bloku, który zwalnia wskazywane dane.
+ * @param[in] ptr : blok z puli
+ * @return poprzedni wskaźnik pomocniczy albo NULL
+ */
+void *PoolTakeAux(void *ptr);
+
+/**
+ * Przydziela z areny bieżącego wątku @p size bajtów wyrównanych do
+ * `max_align_t`. Pamięć jest ważna do zwolnienia areny do wcześniejszego
+ * znacznika albo do jej wyzerowania.
+ * @param[in] size : rozmiar w bajtach
+ * @return wskaźnik na pamięć
+ */
+void *ArenaAlloc(size_t size);
+
+/**
+ * Zwraca znacznik obecnego stanu areny bieżącego wątku.
+ * @return znacznik
+ */
+ArenaMark ArenaSave();
+
+/**
+ * Zwalnia całą pamięć areny bieżącego wątku przydzieloną po zapamiętaniu
+ * znacznika @p mark.
+ * @param[in] mark : znacznik
+ */
+void ArenaRestore(ArenaMark mark);
+
+/**
+ * Zwalnia całą pamięć areny bieżącego wątku.
+ */
+void ArenaReset();
+
+/**
+ * Oddaje innym wątkom listy wolnych bloków i niewykorzystaną część płyty
+ * bieżącego wątku oraz zwalnia pamięć jego areny razem z zapasowym
+ * fragmentem. Wołana przez wątki robocze przed zakończeniem.
+ */
+void AllocThreadRelease();
+
+/**
+ * Zwalnia wszystkie płyty puli i pamięć areny bieżącego wątku.
+ * Wolno ją wołać tylko wtedy, gdy żaden blok z puli nie jest już używany.
+ */
+void AllocRelease();
+
+/**
+ * Zwraca statystyki alokatora.
+ * @return statystyki
+ */
+AllocStats AllocGetStats();
+
+#endif /* __ALLOCATOR_H__ */
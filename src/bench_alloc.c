@@ -0,0 +1,137 @@
+/** @file
+   Pomiar liczby alokacji i przepustowości operacji na małych wielomianach
+
+   Wielomiany wielu zmiennych, w których każdy współczynnik ma od jednego do
+   trzech jednomianów, są wielokrotnie:
+   - mnożone przez `PolyMul`,
+   - składane przez `PolyCompose`,
+   - sumowane z jednomianów przez `PolyAddMonos`.
+   Dla każdej operacji wypisywany jest czas, liczba alokacji modułu wielomianów
+   (`PolyAllocCount`) i liczba bloków przydzielonych z puli na jedną operację.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "allocator.h"
+#include "poly.h"
+
+/**
+ * Liczba powtórzeń każdej operacji.
+ */
+static const unsigned ROUNDS = 20000;
+
+/**
+ * Tworzy pseudolosowy wielomian o głębokości @p depth, w którym każdy
+ * współczynnik ma od jednego do trzech jednomianów.
+ * @param[in] depth : głębokość wielomianu
+ * @return wielomian
+ */
+static Poly SmallPoly(unsigned depth) {
+    if (!depth) {
+        return PolyFromCoeff(1 + rand() % 9);
+    }
+
+    Mono monos[3];
+    unsigned count = 1 + rand() % 3;
+
+    for (unsigned j = 0; j < count; ++j) {
+        Poly c = SmallPoly(depth - 1);
+        monos[j] = MonoFromPoly(&c, rand() % 4);
+    }
+
+    return PolyAddMonos(count, monos);
+}
+
+/**
+ * Zwraca czas procesora w sekundach od początku działania programu.
+ * @return czas w sekundach
+ */
+static double Now() {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/**
+ * Stan liczników na początku pomiaru.
+ */
+typedef struct Measure {
+    double start; ///< czas procesora
+    size_t allocs; ///< `PolyAllocCount()`
+    size_t poolAllocs; ///< `AllocStats::poolAllocs`
+} Measure;
+
+/**
+ * Rozpoczyna pomiar.
+ * @return stan liczników
+ */
+static Measure MeasureStart() {
+    return (Measure) {.start = Now(), .allocs = PolyAllocCount(),
+                      .poolAllocs = AllocGetStats().poolAllocs};
+}
+
+/**
+ * Kończy pomiar @p m operacji @p name i wypisuje wyniki.
+ * @param[in] m : stan liczników na początku pomiaru
+ * @param[in] name : nazwa operacji
+ */
+static void MeasureEnd(Measure m, const char *name) {
+    double elapsed = Now() - m.start;
+    size_t allocs = PolyAllocCount() - m.allocs;
+    size_t poolAllocs = AllocGetStats().poolAllocs - m.poolAllocs;
+
+    printf("%-12s %10.2f %12.0f %12.2f %12.2f\n", name, 1000 * elapsed,
+           ROUNDS / (elapsed > 0 ? elapsed : 1e-9), (double)allocs / ROUNDS,
+           (double)poolAllocs / ROUNDS);
+}
+
+/**
+ * Funkcja główna programu pomiarowego.
+ * @return kod wyjścia programu
+ */
+int main() {
+    srand(2017);
+    printf("%-12s %10s %12s %12s %12s\n", "operation", "time[ms]", "ops/s", "allocs/op",
+           "blocks/op");
+
+    Measure m = MeasureStart();
+
+    for (unsigned j = 0; j < ROUNDS; ++j) {
+        Poly p = SmallPoly(3);
+        PolyDestroy(&p);
+    }
+
+    MeasureEnd(m, "AddMonos");
+
+    Poly p = SmallPoly(3), q = SmallPoly(3);
+    m = MeasureStart();
+
+    for (unsigned j = 0; j < ROUNDS; ++j) {
+        Poly r = PolyMul(&p, &q);
+        PolyDestroy(&r);
+    }
+
+    MeasureEnd(m, "Mul");
+
+    Poly x[3] = {SmallPoly(1), SmallPoly(2), SmallPoly(1)};
+    m = MeasureStart();
+
+    for (unsigned j = 0; j < ROUNDS; ++j) {
+        Poly r = PolyCompose(&p, 3, x);
+        PolyDestroy(&r);
+    }
+
+    MeasureEnd(m, "Compose");
+
+    PolyDestroy(&p), PolyDestroy(&q);
+
+    for (unsigned j = 0; j < 3; ++j) {
+        PolyDestroy(&x[j]);
+    }
+
+    return 0;
+}
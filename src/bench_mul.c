@@ -0,0 +1,123 @@
+/** @file
+   Pomiar czasu mnożenia wielomianów różnymi metodami
+
+   Dla kolejnych rozmiarów `n` mnoży dwa wielomiany jednej zmiennej o `n`
+   jednomianach:
+   - rzadko (wykładniki co 3, więc `PolyMul` wybiera mnożenie kopcem),
+   - gęsto przez `PolyMul` (Karacuba/Toom-3 lub NTT zależnie od progów),
+   - gęsto bezpośrednio przez `NttMul`,
+   i wypisuje czasy w milisekundach, co pozwala odczytać punkty przecięcia.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ntt.h"
+#include "poly.h"
+
+/**
+ * Czas pojedynczego pomiaru (w sekundach), po którego przekroczeniu dana metoda
+ * nie jest już mierzona dla większych rozmiarów.
+ */
+static const double TIME_LIMIT = 5.0;
+
+/**
+ * Tworzy wielomian jednej zmiennej o @p n jednomianach z wykładnikami
+ * `0, stride, 2 * stride, ...` i pseudolosowymi współczynnikami.
+ * @param[in] n : liczba jednomianów
+ * @param[in] stride : odstęp między wykładnikami
+ * @param[out] coeffs : tablica o rozmiarze @p n na współczynniki
+ * @return wielomian
+ */
+static Poly BenchPoly(unsigned n, unsigned stride, poly_coeff_t coeffs[]) {
+    Mono *monos = malloc(sizeof(Mono) * n);
+    assert(monos != NULL);
+
+    for (unsigned j = 0; j < n; ++j) {
+        coeffs[j] = (poly_coeff_t)(rand() % 1999) - 999;
+        coeffs[j] += !coeffs[j];
+        Poly c = PolyFromCoeff(coeffs[j]);
+        monos[j] = MonoFromPoly(&c, (poly_exp_t)(j * stride));
+    }
+
+    Poly p = PolyAddMonos(n, monos);
+    free(monos);
+
+    return p;
+}
+
+/**
+ * Zwraca czas procesora w sekundach od początku działania programu.
+ * @return czas w sekundach
+ */
+static double Now() {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/**
+ * Funkcja główna programu pomiarowego.
+ * @return kod wyjścia programu
+ */
+int main() {
+    bool sparseEnabled = true, denseEnabled = true, nttEnabled = true;
+
+    printf("%10s %12s %12s %12s\n", "n", "sparse[ms]", "PolyMul[ms]", "NttMul[ms]");
+
+    for (unsigned n = 64; n <= (1u << 20); n *= 2) {
+        poly_coeff_t *a = malloc(sizeof(poly_coeff_t) * n);
+        poly_coeff_t *b = malloc(sizeof(poly_coeff_t) * n);
+        poly_coeff_t *res = malloc(sizeof(poly_coeff_t) * (2 * n - 1));
+        assert(a != NULL && b != NULL && res != NULL);
+
+        printf("%10u", n);
+
+        if (sparseEnabled) {
+            Poly p = BenchPoly(n, 3, a);
+            Poly q = BenchPoly(n, 3, b);
+            double start = Now();
+            Poly r = PolyMul(&p, &q);
+            double elapsed = Now() - start;
+            printf(" %12.2f", 1000 * elapsed);
+            sparseEnabled = elapsed < TIME_LIMIT;
+            PolyDestroy(&p), PolyDestroy(&q), PolyDestroy(&r);
+        } else {
+            printf(" %12s", "-");
+        }
+
+        if (denseEnabled) {
+            Poly p = BenchPoly(n, 1, a);
+            Poly q = BenchPoly(n, 1, b);
+            double start = Now();
+            Poly r = PolyMul(&p, &q);
+            double elapsed = Now() - start;
+            printf(" %12.2f", 1000 * elapsed);
+            denseEnabled = elapsed < TIME_LIMIT;
+            PolyDestroy(&p), PolyDestroy(&q), PolyDestroy(&r);
+        } else {
+            printf(" %12s", "-");
+        }
+
+        if (nttEnabled) {
+            double start = Now();
+            NttMul(a, n, b, n, res);
+            double elapsed = Now() - start;
+            printf(" %12.2f", 1000 * elapsed);
+            nttEnabled = elapsed < TIME_LIMIT;
+        } else {
+            printf(" %12s", "-");
+        }
+
+        printf("\n");
+        fflush(stdout);
+
+        free(a), free(b), free(res);
+    }
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+/** @file
+   Implementacja mnożenia gęstych wielomianów jednej zmiennej
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "densemul.h"
+#include "ntt.h"
+#include "utils.h"
+
+/**
+ * Typ słowa, na którym liczymy iloczyny modulo @f$2^{64}@f$.
+ * Arytmetyka na typie bez znaku zawija się tak samo jak `poly_coeff_t`,
+ * ale bez zachowania niezdefiniowanego.
+ */
+typedef unsigned long dense_word_t;
+
+/**
+ * Typ słowa, na którym liczymy algorytmem Toom-3.
+ * Interpolacja w Toom-3 dzieli przez 2, co modulo @f$2^{64}@f$ gubi bit, więc
+ * liczymy modulo @f$2^{128}@f$; każdy poziom rekurencji gubi co najwyżej dwa
+ * najstarsze bity, a wynik potrzebny jest tylko modulo @f$2^{64}@f$.
+ */
+typedef unsigned __int128 dense_wide_t;
+
+/**
+ * Generuje funkcje mnożące metodą szkolną i algorytmem Karacuby tablice
+ * współczynników typu @p TYPE.
+ * Funkcja `NAME(a, b, n, res, scratch)` mnoży tablice @p a i @p b o rozmiarze
+ * `n` i zapisuje `2n - 1` współczynników iloczynu do `res`, korzystając
+ * z pamięci pomocniczej `scratch` o rozmiarze `KaratsubaScratch(n)`.
+ * @param NAME : nazwa funkcji
+ * @param TYPE : typ współczynników
+ */
+#define DEFINE_KARATSUBA(NAME, TYPE) \
+static void NAME##Basecase(const TYPE a[], const TYPE b[], size_t n, TYPE res[]) { \
+    memset(res, 0, sizeof(TYPE) * (2 * n - 1)); \
+    for (size_t i = 0; i < n; ++i) { \
+        for (size_t j = 0; j < n; ++j) { \
+            res[i + j] += a[i] * b[j]; \
+        } \
+    } \
+} \
+\
+static void NAME(const TYPE a[], const TYPE b[], size_t n, TYPE res[], TYPE scratch[]) { \
+    if (n < KARATSUBA_THRESHOLD) { \
+        NAME##Basecase(a, b, n, res); \
+        return; \
+    } \
+    size_t m = (n + 1) / 2; \
+    size_t h = n - m; \
+    TYPE *sa = scratch; \
+    TYPE *sb = sa + m; \
+    TYPE *z1 = sb + m; \
+    TYPE *rest = z1 + 2 * m - 1; \
+    for (size_t i = 0; i < m; ++i) { \
+        sa[i] = a[i] + (i < h ? a[m + i] : 0); \
+        sb[i] = b[i] + (i < h ? b[m + i] : 0); \
+    } \
+    NAME(a, b, m, res, rest); \
+    NAME(a + m, b + m, h, res + 2 * m, rest); \
+    res[2 * m - 1] = 0; \
+    NAME(sa, sb, m, z1, rest); \
+    for (size_t i = 0; i < 2 * m - 1; ++i) { \
+        z1[i] -= res[i]; \
+    } \
+    for (size_t i = 0; i < 2 * h - 1; ++i) { \
+        z1[i] -= res[2 * m + i]; \
+    } \
+    for (size_t i = 0; i < 2 * m - 1; ++i) { \
+        res[m + i] += z1[i]; \
+    } \
+}
+
+DEFINE_KARATSUBA(KaratsubaMul, dense_word_t)
+DEFINE_KARATSUBA(KaratsubaMulWide, dense_wide_t)
+
+/**
+ * Zwraca rozmiar pamięci pomocniczej potrzebnej algorytmowi Karacuby
+ * dla tablic o rozmiarze @p n.
+ * @param[in] n : rozmiar mnożonych tablic
+ * @return liczba współczynników pamięci pomocniczej
+ */
+static size_t KaratsubaScratch(size_t n) {
+    size_t result = 0;
+
+    while (n >= KARATSUBA_THRESHOLD) {
+        n = (n + 1) / 2;
+        result += 4 * n - 1;
+    }
+
+    return result;
+}
+
+/**
+ * Zwraca rozmiar pamięci pomocniczej potrzebnej algorytmowi Toom-3
+ * dla tablic o rozmiarze @p n.
+ * @param[in] n : rozmiar mnożonych tablic
+ * @return liczba współczynników pamięci pomocniczej
+ */
+static size_t Toom3Scratch(size_t n) {
+    size_t result = 0;
+
+    while (n >= TOOM3_THRESHOLD) {
+        n = (n + 2) / 3;
+        result += 12 * n;
+    }
+
+    return result + KaratsubaScratch(n);
+}
+
+/**
+ * Mnoży tablice @p a i @p b o rozmiarze @p n algorytmem Toom-3 z punktami
+ * interpolacji `0, 1, -1, -2, ∞` i zapisuje `2n - 1` współczynników iloczynu
+ * do @p res.
+ * @param[in] a : tablica współczynników
+ * @param[in] b : tablica współczynników
+ * @param[in] n : rozmiar tablic @p a i @p b
+ * @param[out] res : tablica na iloczyn
+ * @param[in] scratch : pamięć pomocnicza o rozmiarze `Toom3Scratch(n)`
+ */
+static void Toom3Mul(const dense_wide_t a[], const dense_wide_t b[], size_t n,
+                     dense_wide_t res[], dense_wide_t scratch[]) {
+    if (n < TOOM3_THRESHOLD) {
+        KaratsubaMulWide(a, b, n, res, scratch);
+        return;
+    }
+
+    /**
+     * Odwrotność liczby 3 modulo @f$2^{128}@f$.
+     */
+    const dense_wide_t INV3 = ((dense_wide_t)0xAAAAAAAAAAAAAAAAUL << 64)
+                              | 0xAAAAAAAAAAAAAAABUL;
+
+    size_t k = (n + 2) / 3;
+    size_t r = n - 2 * k;
+    dense_wide_t *a1 = scratch, *am1 = a1 + k, *am2 = am1 + k;
+    dense_wide_t *b1 = am2 + k, *bm1 = b1 + k, *bm2 = bm1 + k;
+    dense_wide_t *v1 = bm2 + k, *vm1 = v1 + 2 * k, *vm2 = vm1 + 2 * k;
+    dense_wide_t *rest = vm2 + 2 * k;
+
+    for (size_t i = 0; i < k; ++i) {
+        dense_wide_t x0 = a[i], x1 = a[k + i], x2 = (i < r) ? a[2 * k + i] : 0;
+        dense_wide_t y0 = b[i], y1 = b[k + i], y2 = (i < r) ? b[2 * k + i] : 0;
+
+        a1[i] = x0 + x1 + x2;
+        am1[i] = x0 - x1 + x2;
+        am2[i] = x0 - 2 * x1 + 4 * x2;
+        b1[i] = y0 + y1 + y2;
+        bm1[i] = y0 - y1 + y2;
+        bm2[i] = y0 - 2 * y1 + 4 * y2;
+    }
+
+    Toom3Mul(a, b, k, res, rest);
+    Toom3Mul(a + 2 * k, b + 2 * k, r, res + 4 * k, rest);
+    Toom3Mul(a1, b1, k, v1, rest);
+    Toom3Mul(am1, bm1, k, vm1, rest);
+    Toom3Mul(am2, bm2, k, vm2, rest);
+
+    for (size_t i = 0; i < 2 * k - 1; ++i) {
+        dense_wide_t v0 = res[i];
+        dense_wide_t vinf = (i < 2 * r - 1) ? res[4 * k + i] : 0;
+
+        dense_wide_t t3 = (vm2[i] - v1[i]) * INV3;
+        dense_wide_t t1 = (v1[i] - vm1[i]) >> 1;
+        dense_wide_t t2 = vm1[i] - v0;
+        t3 = ((t2 - t3) >> 1) + 2 * vinf;
+        t2 = t2 + t1 - vinf;
+        t1 = t1 - t3;
+
+        v1[i] = t1;
+        vm1[i] = t2;
+        vm2[i] = t3;
+    }
+
+    memset(res + 2 * k - 1, 0, sizeof(dense_wide_t) * (2 * k + 1));
+
+    for (size_t i = 0; i < 2 * k - 1; ++i) {
+        res[k + i] += v1[i];
+        res[2 * k + i] += vm1[i];
+
+        if (3 * k + i < 2 * n - 1) {
+            res[3 * k + i] += vm2[i];
+        }
+    }
+}
+
+/**
+ * Mnoży tablice @p a i @p b o rozmiarze @p n i zapisuje `2n - 1` współczynników
+ * iloczynu do @p res, wybierając algorytm w zależności od rozmiaru.
+ * @param[in] a : tablica współczynników
+ * @param[in] b : tablica współczynników
+ * @param[in] n : rozmiar tablic @p a i @p b
+ * @param[out] res : tablica na iloczyn
+ */
+static void BalancedMul(const dense_word_t a[], const dense_word_t b[], size_t n,
+                        dense_word_t res[]) {
+    ArenaMark mark = ArenaSave();
+
+    if (n < TOOM3_THRESHOLD) {
+        dense_word_t *scratch = ArenaAlloc(sizeof(dense_word_t) * (KaratsubaScratch(n) + 1));
+
+        KaratsubaMul(a, b, n, res, scratch);
+    } else {
+        dense_wide_t *wide = ArenaAlloc(sizeof(dense_wide_t) * (4 * n - 1 + Toom3Scratch(n)));
+        dense_wide_t *wa = wide, *wb = wa + n, *wres = wb + n, *scratch = wres + 2 * n - 1;
+
+        for (size_t i = 0; i < n; ++i) {
+            wa[i] = a[i];
+            wb[i] = b[i];
+        }
+
+        Toom3Mul(wa, wb, n, wres, scratch);
+
+        for (size_t i = 0; i < 2 * n - 1; ++i) {
+            res[i] = (dense_word_t)wres[i];
+        }
+    }
+
+    ArenaRestore(mark);
+}
+
+/**
+ * Mnoży tablice @p a i @p b o rozmiarach @p n i @p m, gdzie `n >= m`,
+ * dzieląc @p a na bloki rozmiaru @p m.
+ * @param[in] a : tablica współczynników
+ * @param[in] n : rozmiar tablicy @p a
+ * @param[in] b : tablica współczynników
+ * @param[in] m : rozmiar tablicy @p b
+ * @param[out] res : tablica o rozmiarze `n + m - 1` na iloczyn
+ */
+static void DenseMulRec(const dense_word_t a[], size_t n, const dense_word_t b[],
+                        size_t m, dense_word_t res[]) {
+    if (n < m) {
+        DenseMulRec(b, m, a, n, res);
+        return;
+    }
+
+    memset(res, 0, sizeof(dense_word_t) * (n + m - 1));
+
+    if (m < KARATSUBA_THRESHOLD) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                res[i + j] += a[i] * b[j];
+            }
+        }
+
+        return;
+    }
+
+    ArenaMark mark = ArenaSave();
+    dense_word_t *block = ArenaAlloc(sizeof(dense_word_t) * (2 * m - 1));
+
+    for (size_t off = 0; off < n; off += m) {
+        size_t len = (n - off < m) ? n - off : m;
+
+        if (len == m) {
+            BalancedMul(a + off, b, m, block);
+        } else {
+            DenseMulRec(b, m, a + off, len, block);
+        }
+
+        for (size_t i = 0; i < len + m - 1; ++i) {
+            res[off + i] += block[i];
+        }
+    }
+
+    ArenaRestore(mark);
+}
+
+void DenseMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+              size_t m, poly_coeff_t res[]) {
+    if (n >= NTT_THRESHOLD && m >= NTT_THRESHOLD) {
+        NttMul(a, n, b, m, res);
+        return;
+    }
+
+    DenseMulRec((const dense_word_t *)a, n, (const dense_word_t *)b, m,
+                (dense_word_t *)res);
+}
@@ -0,0 +1,81 @@
+/** @file
+   Interfejs mnożenia gęstych wielomianów jednej zmiennej
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __DENSEMUL_H__
+#define __DENSEMUL_H__
+
+#include <stddef.h>
+
+#include "poly.h"
+
+/**
+ * Próg rozmiaru, poniżej którego mnożymy metodą szkolną zamiast algorytmem
+ * Karacuby.
+ */
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 32
+#endif
+
+/**
+ * Próg rozmiaru, od którego mnożymy algorytmem Toom-3 zamiast algorytmem
+ * Karacuby.
+ */
+#ifndef TOOM3_THRESHOLD
+#define TOOM3_THRESHOLD 384
+#endif
+
+/**
+ * Najmniejsza liczba jednomianów każdego z czynników, przy której `PolyMul`
+ * rozważa mnożenie w reprezentacji gęstej.
+ */
+#ifndef DENSE_MUL_MIN_SIZE
+#define DENSE_MUL_MIN_SIZE 64
+#endif
+
+/**
+ * Najmniejsza gęstość (w procentach) każdego z czynników, przy której
+ * `PolyMul` mnoży w reprezentacji gęstej. Gęstość to stosunek liczby jednomianów
+ * do stopnia powiększonego o jeden.
+ */
+#ifndef DENSE_MUL_MIN_DENSITY_PERCENT
+#define DENSE_MUL_MIN_DENSITY_PERCENT 50
+#endif
+
+/**
+ * Największy rozmiar tablicy, do której `PolyMul` pakuje wielomiany wielu
+ * zmiennych przy podstawieniu Kroneckera.
+ */
+#ifndef KRONECKER_MAX_LENGTH
+#define KRONECKER_MAX_LENGTH (1 << 22)
+#endif
+
+/**
+ * Najmniejsza gęstość (w procentach) każdego z czynników wielu zmiennych, przy
+ * której `PolyMul` mnoży przez podstawienie Kroneckera. Gęstość to stosunek
+ * liczby niezerowych współczynników liczbowych do iloczynu stopni względem
+ * kolejnych zmiennych powiększonych o jeden.
+ */
+#ifndef KRONECKER_MIN_DENSITY_PERCENT
+#define KRONECKER_MIN_DENSITY_PERCENT 25
+#endif
+
+/**
+ * Mnoży dwa wielomiany gęste zapisane jako tablice współczynników
+ * (współczynnik przy `x^i` jest na pozycji `i`).
+ * Arytmetyka jest modulo @f$2^{64}@f$, tak jak przy przepełnieniach typu
+ * `poly_coeff_t` w pozostałych operacjach na wielomianach.
+ * @param[in] a : tablica współczynników pierwszego czynnika
+ * @param[in] n : rozmiar tablicy @p a (dodatni)
+ * @param[in] b : tablica współczynników drugiego czynnika
+ * @param[in] m : rozmiar tablicy @p b (dodatni)
+ * @param[out] res : tablica o rozmiarze `n + m - 1` na współczynniki iloczynu
+ */
+void DenseMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+              size_t m, poly_coeff_t res[]);
+
+#endif /* __DENSEMUL_H__ */
@@ -0,0 +1,312 @@
+/** @file
+   Implementacja zamrożonych wielomianów
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "frozen.h"
+#include "power.h"
+#include "utils.h"
+
+/**
+ * Liczy węzły drzewa wielomianu @p p.
+ * @param[in] p : wielomian
+ * @return liczba węzłów
+ */
+static size_t PolyNodeCount(const Poly *p) {
+    size_t result = 1;
+
+    if (!PolyIsCoeff(p)) {
+        for (unsigned j = 0; j < p->size; ++j) {
+            result += PolyNodeCount(&p->monos[j].p);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Zapisuje poddrzewo wielomianu @p p w tablicy @p nodes od pozycji @p k.
+ * @param[in] p : wielomian
+ * @param[in] exp : wykładnik jednomianu, którego współczynnikiem jest @p p
+ * @param[out] nodes : tablica węzłów
+ * @param[in] k : pozycja węzła @p p
+ * @return pozycja pierwszego węzła za poddrzewem
+ */
+static size_t FreezeRec(const Poly *p, poly_exp_t exp, FrozenNode nodes[], size_t k) {
+    size_t next = k + 1;
+
+    nodes[k].exp = exp;
+
+    if (PolyIsCoeff(p)) {
+        nodes[k].coeff = p->coeff;
+        nodes[k].size = 0;
+    } else {
+        nodes[k].coeff = 0;
+        nodes[k].size = p->size;
+
+        for (unsigned j = 0; j < p->size; ++j) {
+            next = FreezeRec(&p->monos[j].p, p->monos[j].exp, nodes, next);
+        }
+    }
+
+    nodes[k].end = (unsigned)next;
+
+    return next;
+}
+
+FrozenPoly *PolyFreeze(const Poly *p) {
+    size_t count = PolyNodeCount(p);
+    size_t bytes = sizeof(FrozenPoly) + sizeof(FrozenNode) * count;
+    FrozenPoly *f = PoolAlloc(bytes);
+
+    // Zerujemy też bajty wyrównania, żeby kopia bloku nie zależała od
+    // poprzedniej zawartości pamięci.
+    memset(f, 0, bytes);
+    f->count = count;
+    FreezeRec(p, -1, f->nodes, 0);
+
+    return f;
+}
+
+/**
+ * Odtwarza wielomian z poddrzewa węzła @p k pomnożony przez @p mult, tak jak
+ * `PolyCloneScaled` w module wielomianów: pomija współczynniki, które się
+ * wyzerowały, i zastępuje współczynnikiem wielomian złożony z samego wyrazu
+ * wolnego.
+ * @param[in] nodes : tablica węzłów
+ * @param[in] k : pozycja węzła
+ * @param[in] mult : mnożnik
+ * @return wielomian
+ */
+static Poly ThawScaled(const FrozenNode nodes[], size_t k, poly_coeff_t mult) {
+    if (!nodes[k].size) {
+        return PolyFromCoeff(nodes[k].coeff * mult);
+    }
+
+    Mono *monos = PoolAlloc(sizeof(Mono) * nodes[k].size);
+    unsigned newSize = 0;
+
+    for (size_t c = k + 1; c < nodes[k].end; c = nodes[c].end) {
+        Poly p = ThawScaled(nodes, c, mult);
+
+        if (!PolyIsZero(&p)) {
+            monos[newSize++] = MonoFromPoly(&p, nodes[c].exp);
+        }
+    }
+
+    if (!newSize) {
+        PoolFree(monos);
+        return PolyZero();
+    } else if (newSize == 1 && monos[0].exp == -1) {
+        Poly c = monos[0].p;
+        PoolFree(monos);
+        return c;
+    } else if (newSize < nodes[k].size) {
+        monos = PoolRealloc(monos, sizeof(Mono) * newSize);
+    }
+
+    return (Poly) {.monos = monos, .size = newSize};
+}
+
+Poly PolyThaw(const FrozenPoly *f) {
+    return ThawScaled(f->nodes, 0, 1);
+}
+
+void FrozenDestroy(FrozenPoly *f) {
+    PoolFree(f);
+}
+
+size_t FrozenBytes(const FrozenPoly *f) {
+    return sizeof(FrozenPoly) + sizeof(FrozenNode) * f->count;
+}
+
+bool FrozenIsEq(const FrozenPoly *f, const FrozenPoly *g) {
+    if (f->count != g->count) {
+        return false;
+    }
+
+    for (size_t k = 0; k < f->count; ++k) {
+        if (f->nodes[k].coeff != g->nodes[k].coeff || f->nodes[k].exp != g->nodes[k].exp
+            || f->nodes[k].size != g->nodes[k].size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Zwraca stopień wielomianu z poddrzewa węzła @p k niebędącego
+ * współczynnikiem.
+ * @param[in] nodes : tablica węzłów
+ * @param[in] k : pozycja węzła
+ * @return stopień wielomianu
+ */
+static poly_exp_t FrozenDegRec(const FrozenNode nodes[], size_t k) {
+    poly_exp_t result = 0;
+
+    for (size_t c = k + 1; c < nodes[k].end; c = nodes[c].end) {
+        poly_exp_t deg = (nodes[c].exp < 0) ? 0 : nodes[c].exp;
+
+        if (nodes[c].size) {
+            deg += FrozenDegRec(nodes, c);
+        }
+
+        result = (deg > result) ? deg : result;
+    }
+
+    return result;
+}
+
+poly_exp_t FrozenDeg(const FrozenPoly *f) {
+    if (!f->nodes[0].size) {
+        return f->nodes[0].coeff ? 0 : -1;
+    }
+
+    return FrozenDegRec(f->nodes, 0);
+}
+
+/**
+ * Zwraca stopień wielomianu z poddrzewa węzła @p k niebędącego
+ * współczynnikiem ze względu na zmienną o indeksie @p var_idx.
+ * @param[in] nodes : tablica węzłów
+ * @param[in] k : pozycja węzła
+ * @param[in] var_idx : indeks zmiennej
+ * @return stopień wielomianu
+ */
+static poly_exp_t FrozenDegByRec(const FrozenNode nodes[], size_t k, unsigned var_idx) {
+    poly_exp_t result = 0;
+
+    for (size_t c = k + 1; c < nodes[k].end; c = nodes[c].end) {
+        poly_exp_t deg = 0;
+
+        if (!var_idx) {
+            deg = (nodes[c].exp < 0) ? 0 : nodes[c].exp;
+        } else if (nodes[c].size) {
+            deg = FrozenDegByRec(nodes, c, var_idx - 1);
+        }
+
+        result = (deg > result) ? deg : result;
+    }
+
+    return result;
+}
+
+poly_exp_t FrozenDegBy(const FrozenPoly *f, unsigned var_idx) {
+    if (!f->nodes[0].size) {
+        return f->nodes[0].coeff ? 0 : -1;
+    }
+
+    return FrozenDegByRec(f->nodes, 0, var_idx);
+}
+
+Poly FrozenAt(const FrozenPoly *f, poly_coeff_t x) {
+    const FrozenNode *nodes = f->nodes;
+
+    if (!nodes[0].size) {
+        return PolyFromCoeff(nodes[0].coeff);
+    }
+
+    unsigned total = 0;
+    bool allCoeffs = true;
+
+    for (size_t c = 1; c < f->count; c = nodes[c].end) {
+        total += nodes[c].size ? nodes[c].size : 1;
+        allCoeffs &= !nodes[c].size;
+    }
+
+    PowerWalk walk = PowerWalkStart(x);
+
+    // Wszystkie współczynniki są stałymi - wynik liczymy bez alokacji.
+    if (allCoeffs) {
+        poly_coeff_t result = 0;
+
+        for (size_t c = 1; c < f->count && PowerWalkLive(&walk); c = nodes[c].end) {
+            result += nodes[c].coeff * PowerWalkNext(&walk, nodes[c].exp);
+        }
+
+        return PolyFromCoeff(result);
+    }
+
+    ArenaMark mark = ArenaSave();
+    Mono *monos = ArenaAlloc(sizeof(Mono) * total);
+    unsigned count = 0;
+
+    for (size_t c = 1; c < f->count && PowerWalkLive(&walk); c = nodes[c].end) {
+        poly_coeff_t power = PowerWalkNext(&walk, nodes[c].exp);
+
+        if (!nodes[c].size) {
+            monos[count++] = (Mono) {.p = PolyFromCoeff(nodes[c].coeff * power), .exp = -1};
+        } else {
+            for (size_t g = c + 1; g < nodes[c].end; g = nodes[g].end) {
+                Poly scaled = ThawScaled(nodes, g, power);
+                monos[count++] = MonoFromPoly(&scaled, nodes[g].exp);
+            }
+        }
+    }
+
+    Poly result = PolyAddMonos(count, monos);
+    ArenaRestore(mark);
+
+    return result;
+}
+
+/**
+ * Wypisuje wielomian z poddrzewa węzła @p k powiększony o stałą @p extra.
+ * Tak jak `PolyPrint` wyraz wolny wielomianu mającego jednomian przy `x^0`
+ * wypisujemy jako wyraz wolny współczynnika tego jednomianu.
+ * @param[in] nodes : tablica węzłów
+ * @param[in] k : pozycja węzła
+ * @param[in] extra : stała dodawana do wielomianu
+ */
+static void FrozenPrintRec(const FrozenNode nodes[], size_t k, poly_coeff_t extra) {
+    if (!nodes[k].size) {
+        printf("%ld", nodes[k].coeff + extra);
+        return;
+    }
+
+    size_t c = k + 1;
+    poly_coeff_t constant = extra;
+    bool first = true;
+
+    if (nodes[c].exp == -1) {
+        constant += nodes[c].coeff;
+        c = nodes[c].end;
+    }
+
+    if (constant) {
+        printf("(");
+
+        if (c < nodes[k].end && nodes[c].exp == 0) {
+            FrozenPrintRec(nodes, c, constant);
+            c = nodes[c].end;
+        } else {
+            printf("%ld", constant);
+        }
+
+        printf(",0)");
+        first = false;
+    }
+
+    for (; c < nodes[k].end; c = nodes[c].end) {
+        if (!first) {
+            printf("+");
+        }
+
+        printf("(");
+        FrozenPrintRec(nodes, c, 0);
+        printf(",%d)", (nodes[c].exp < 0) ? 0 : nodes[c].exp);
+        first = false;
+    }
+}
+
+void FrozenPrint(const FrozenPoly *f) {
+    FrozenPrintRec(f->nodes, 0, 0);
+}
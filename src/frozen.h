@@ -0,0 +1,112 @@
+/** @file
+   Interfejs zamrożonych wielomianów
+
+   Zamrożony wielomian to całe drzewo wielomianu zapisane w jednym ciągłym
+   bloku pamięci w kolejności pre-order: po węźle wielomianu następują kolejno
+   poddrzewa jego współczynników. Zamiast wskaźników węzeł przechowuje pozycję
+   pierwszego węzła za swoim poddrzewem, więc blok można skopiować przez
+   `memcpy` albo odwzorować z pliku bez przeliczania adresów.
+   Zamrożonego wielomianu nie można modyfikować; służy do wielokrotnego
+   czytania (wartościowania, porównywania, wypisywania) i zajmuje jedną
+   alokację zamiast osobnej tablicy jednomianów dla każdego węzła.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __FROZEN_H__
+#define __FROZEN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "poly.h"
+
+/**
+ * Węzeł zamrożonego wielomianu.
+ */
+typedef struct FrozenNode {
+    poly_coeff_t coeff; ///< współczynnik albo 0, jeśli węzeł nie jest współczynnikiem
+    poly_exp_t exp; ///< wykładnik jednomianu, którego współczynnikiem jest węzeł; -1 dla korzenia
+    unsigned size; ///< liczba jednomianów albo 0 dla współczynnika
+    unsigned end; ///< pozycja pierwszego węzła za poddrzewem węzła
+} FrozenNode;
+
+/**
+ * Zamrożony wielomian: nagłówek i węzły w jednym bloku pamięci.
+ */
+typedef struct FrozenPoly {
+    size_t count; ///< liczba węzłów
+    FrozenNode nodes[]; ///< węzły w kolejności pre-order; `nodes[0]` to korzeń
+} FrozenPoly;
+
+/**
+ * Zamraża wielomian @p p.
+ * @param[in] p : wielomian
+ * @return zamrożony wielomian w bloku z puli
+ */
+FrozenPoly *PolyFreeze(const Poly *p);
+
+/**
+ * Odtwarza zwykły wielomian z zamrożonego wielomianu @p f.
+ * @param[in] f : zamrożony wielomian
+ * @return wielomian równy @p f
+ */
+Poly PolyThaw(const FrozenPoly *f);
+
+/**
+ * Usuwa zamrożony wielomian z pamięci.
+ * @param[in] f : zamrożony wielomian albo NULL
+ */
+void FrozenDestroy(FrozenPoly *f);
+
+/**
+ * Zwraca rozmiar bloku pamięci zamrożonego wielomianu @p f; tyle bajtów od
+ * adresu @p f wystarczy skopiować, żeby otrzymać jego kopię.
+ * @param[in] f : zamrożony wielomian
+ * @return rozmiar w bajtach
+ */
+size_t FrozenBytes(const FrozenPoly *f);
+
+/**
+ * Sprawdza równość dwóch zamrożonych wielomianów. Postać wielomianów jest
+ * jednoznaczna, więc wystarcza jeden przebieg po obu tablicach węzłów.
+ * @param[in] f : zamrożony wielomian
+ * @param[in] g : zamrożony wielomian
+ * @return `f = g`
+ */
+bool FrozenIsEq(const FrozenPoly *f, const FrozenPoly *g);
+
+/**
+ * Zwraca stopień zamrożonego wielomianu (-1 dla wielomianu tożsamościowo
+ * równego zeru).
+ * @param[in] f : zamrożony wielomian
+ * @return stopień wielomianu @p f
+ */
+poly_exp_t FrozenDeg(const FrozenPoly *f);
+
+/**
+ * Zwraca stopień zamrożonego wielomianu ze względu na zadaną zmienną (-1 dla
+ * wielomianu tożsamościowo równego zeru).
+ * @param[in] f : zamrożony wielomian
+ * @param[in] var_idx : indeks zmiennej
+ * @return stopień wielomianu @p f z względu na zmienną o indeksie @p var_idx
+ */
+poly_exp_t FrozenDegBy(const FrozenPoly *f, unsigned var_idx);
+
+/**
+ * Wylicza wartość zamrożonego wielomianu w punkcie @p x tak jak `PolyAt`.
+ * @param[in] f : zamrożony wielomian
+ * @param[in] x : wartość argumentu
+ * @return @f$p(x, x_0, x_1, \ldots)@f$
+ */
+Poly FrozenAt(const FrozenPoly *f, poly_coeff_t x);
+
+/**
+ * Wypisuje zamrożony wielomian w tej samej postaci co `PolyPrint`.
+ * @param[in] f : zamrożony wielomian
+ */
+void FrozenPrint(const FrozenPoly *f);
+
+#endif /* __FROZEN_H__ */
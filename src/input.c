@@ -0,0 +1,168 @@
+/** @file
+   Implementacja buforowanego wejścia kalkulatora wielomianów
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "input.h"
+#include "utils.h"
+
+_Thread_local const char *__inputCursor;
+
+_Thread_local const char *__inputEnd;
+
+/**
+ * Blok, do którego wczytywane jest wejście, albo NULL, jeśli wejście jest
+ * odwzorowane w pamięci albo bieżący wątek czyta wskazany fragment pamięci.
+ */
+static _Thread_local char *inputBlock;
+
+/**
+ * Początek odwzorowania standardowego wejścia w pamięci albo NULL.
+ */
+static void *inputMap;
+
+/**
+ * Rozmiar odwzorowania standardowego wejścia w pamięci.
+ */
+static size_t inputMapSize;
+
+/**
+ * Czy napotkaliśmy już koniec wejścia.
+ */
+static _Thread_local bool inputEof;
+
+#ifndef UNIT_TESTING
+/**
+ * Próbuje odwzorować w pamięci standardowe wejście od bieżącej pozycji do
+ * końca pliku.
+ * @return czy standardowe wejście jest zwykłym plikiem, który udało się
+ * odwzorować?
+ */
+static bool InputMap() {
+    struct stat st;
+
+    if (fstat(STDIN_FILENO, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        return false;
+    }
+
+    off_t offset = lseek(STDIN_FILENO, 0, SEEK_CUR);
+
+    if (offset < 0 || offset >= st.st_size) {
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    inputMap = map;
+    inputMapSize = (size_t)st.st_size;
+    __inputCursor = (const char *)map + offset;
+    __inputEnd = (const char *)map + st.st_size;
+
+    // Przesuwamy pozycję pliku tak, jakbyśmy przeczytali go do końca.
+    lseek(STDIN_FILENO, 0, SEEK_END);
+
+    return true;
+}
+#endif
+
+/**
+ * Wczytuje do bloku wejścia kolejny fragment standardowego wejścia.
+ * @return liczba wczytanych bajtów; 0 oznacza koniec wejścia
+ */
+static size_t InputReadBlock() {
+#ifdef UNIT_TESTING
+    size_t size = 0;
+    int c;
+
+    while (size < INPUT_BLOCK_SIZE && (c = getchar()) != EOF) {
+        inputBlock[size++] = (char)c;
+    }
+
+    return size;
+#else
+    ssize_t size;
+
+    do {
+        size = read(STDIN_FILENO, inputBlock, INPUT_BLOCK_SIZE);
+    } while (size < 0 && errno == EINTR);
+
+    return (size > 0) ? (size_t)size : 0;
+#endif
+}
+
+void InputInit() {
+    inputBlock = NULL;
+    inputMap = NULL;
+    inputMapSize = 0;
+    inputEof = false;
+    __inputCursor = NULL;
+    __inputEnd = NULL;
+
+#ifndef UNIT_TESTING
+    if (InputMap()) {
+        return;
+    }
+#endif
+
+    inputBlock = malloc(INPUT_BLOCK_SIZE);
+    assert(inputBlock != NULL);
+}
+
+int InputRefill() {
+    if (inputEof || !inputBlock) {
+        inputEof = true;
+        return EOF;
+    }
+
+    size_t size = InputReadBlock();
+
+    if (!size) {
+        inputEof = true;
+        return EOF;
+    }
+
+    __inputCursor = inputBlock;
+    __inputEnd = inputBlock + size;
+
+    return (unsigned char)*__inputCursor++;
+}
+
+bool InputIsMapped() {
+    return inputMap != NULL;
+}
+
+void InputSetRange(const char *begin, const char *end) {
+    inputBlock = NULL;
+    inputEof = false;
+    __inputCursor = begin;
+    __inputEnd = end;
+}
+
+void InputRelease() {
+#ifndef UNIT_TESTING
+    if (inputMap) {
+        munmap(inputMap, inputMapSize);
+    }
+#endif
+
+    free(inputBlock);
+    inputBlock = NULL;
+    inputMap = NULL;
+    __inputCursor = NULL;
+    __inputEnd = NULL;
+}
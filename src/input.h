@@ -0,0 +1,111 @@
+/** @file
+   Interfejs buforowanego wejścia kalkulatora wielomianów
+
+   Parser czyta wejście znak po znaku, ale nie woła `getchar` dla każdego
+   znaku: przesuwa wskaźnik po buforze, który jest uzupełniany całymi blokami.
+   Jeśli standardowe wejście jest zwykłym plikiem, bufor jest odwzorowaniem
+   całego pliku w pamięci (`mmap`) i nie trzeba go uzupełniać. W testach
+   jednostkowych bufor jest wypełniany przez `getchar`, żeby działała atrapa
+   standardowego wejścia.
+
+   Bufor i wskaźnik są osobne dla każdego wątku: wątek roboczy może czytać
+   wskazany fragment odwzorowanego wejścia (`InputSetRange`) tymi samymi
+   funkcjami, którymi wątek główny czyta całe wejście.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __INPUT_H__
+#define __INPUT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Rozmiar (w bajtach) bloku, którym wczytywane jest wejście niebędące zwykłym
+ * plikiem.
+ */
+#ifndef INPUT_BLOCK_SIZE
+#define INPUT_BLOCK_SIZE (1 << 16)
+#endif
+
+/**
+ * Pozycja następnego znaku w buforze wejścia.
+ */
+extern _Thread_local const char *__inputCursor;
+
+/**
+ * Koniec wczytanej części bufora wejścia.
+ */
+extern _Thread_local const char *__inputEnd;
+
+/**
+ * Przygotowuje bufor standardowego wejścia. Trzeba ją wywołać przed pierwszym
+ * `InputGetChar`.
+ */
+void InputInit();
+
+/**
+ * Uzupełnia bufor wejścia i zwraca jego pierwszy znak. Woła ją `InputGetChar`,
+ * gdy bufor się wyczerpie.
+ * @return następny znak wejścia albo `EOF`
+ */
+int InputRefill();
+
+/**
+ * Sprawdza, czy standardowe wejście jest odwzorowane w pamięci. Wtedy po
+ * `InputInit` przedział od `__inputCursor` do `__inputEnd` zawiera całą
+ * pozostałą część wejścia.
+ * @return czy standardowe wejście jest odwzorowane w pamięci?
+ */
+bool InputIsMapped();
+
+/**
+ * Ustawia wejście bieżącego wątku na znaki z przedziału `[begin, end)`;
+ * po nich `InputGetChar` zwraca `EOF`. Pamięć przedziału musi pozostać ważna
+ * do końca czytania.
+ * @param[in] begin : początek przedziału
+ * @param[in] end : koniec przedziału
+ */
+void InputSetRange(const char *begin, const char *end);
+
+/**
+ * Zwalnia bufor standardowego wejścia.
+ */
+void InputRelease();
+
+/**
+ * Wczytuje następny znak wejścia. Po końcu wejścia każde kolejne wywołanie
+ * zwraca `EOF`.
+ * @return następny znak wejścia albo `EOF`
+ */
+static inline int InputGetChar() {
+    if (__inputCursor < __inputEnd) {
+        return (unsigned char)*__inputCursor++;
+    }
+
+    return InputRefill();
+}
+
+/**
+ * Zwraca wskaźnik na @p n kolejnych znaków wejścia, jeśli wszystkie są już
+ * w buforze. Znaki nie są wczytywane; do ich pominięcia służy `InputSkip`.
+ * @param[in] n : liczba znaków
+ * @return wskaźnik na następny znak wejścia albo NULL
+ */
+static inline const char *InputAhead(size_t n) {
+    return ((size_t)(__inputEnd - __inputCursor) >= n) ? __inputCursor : NULL;
+}
+
+/**
+ * Pomija @p n kolejnych znaków wejścia, które muszą być już w buforze.
+ * @param[in] n : liczba znaków
+ */
+static inline void InputSkip(size_t n) {
+    __inputCursor += n;
+}
+
+#endif /* __INPUT_H__ */
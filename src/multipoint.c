@@ -0,0 +1,320 @@
+/** @file
+   Implementacja wyliczania wartości wielomianu jednej zmiennej w wielu punktach
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "densemul.h"
+#include "multipoint.h"
+#include "utils.h"
+
+/**
+ * Typ słowa, na którym liczymy modulo @f$2^{64}@f$ bez zachowania
+ * niezdefiniowanego przy przepełnieniach.
+ */
+typedef unsigned long mp_word_t;
+
+/**
+ * Wierzchołek drzewa iloczynów.
+ * Przechowuje unormowany wielomian @f$\prod_{lo \le i < hi} (X - x_i)@f$.
+ */
+typedef struct TreeNode {
+    mp_word_t *c; ///< współczynniki, `c[deg] = 1`
+    size_t deg; ///< stopień wielomianu, równy `hi - lo`
+    size_t lo; ///< indeks pierwszego punktu
+    size_t hi; ///< indeks za ostatnim punktem
+} TreeNode;
+
+/**
+ * Alokuje z areny tablicę @p n słów.
+ * @param[in] n : liczba słów
+ * @return tablica
+ */
+static mp_word_t *WordAlloc(size_t n) {
+    return ArenaAlloc(sizeof(mp_word_t) * (n ? n : 1));
+}
+
+/**
+ * Mnoży tablice współczynników @p a i @p b przy pomocy `DenseMul`.
+ * @param[in] a : tablica współczynników
+ * @param[in] n : rozmiar tablicy @p a (dodatni)
+ * @param[in] b : tablica współczynników
+ * @param[in] m : rozmiar tablicy @p b (dodatni)
+ * @param[out] res : tablica o rozmiarze `n + m - 1` na iloczyn
+ */
+static inline void WordMul(const mp_word_t a[], size_t n, const mp_word_t b[],
+                           size_t m, mp_word_t res[]) {
+    DenseMul((const poly_coeff_t *)a, n, (const poly_coeff_t *)b, m,
+             (poly_coeff_t *)res);
+}
+
+/**
+ * Wylicza schematem Hornera wartość wielomianu @p f w punkcie @p x.
+ * @param[in] f : tablica współczynników
+ * @param[in] n : rozmiar tablicy @p f
+ * @param[in] x : punkt
+ * @return `f(x)`
+ */
+static mp_word_t Horner(const mp_word_t f[], size_t n, mp_word_t x) {
+    mp_word_t result = 0;
+
+    while (n--) {
+        result = result * x + f[n];
+    }
+
+    return result;
+}
+
+/**
+ * Wylicza odwrotność szeregu potęgowego @p h o wyrazie wolnym 1 modulo
+ * `X^prec` metodą Newtona.
+ * @param[in] h : tablica współczynników szeregu, `h[0] = 1`
+ * @param[in] hn : rozmiar tablicy @p h
+ * @param[in] prec : żądana dokładność (dodatnia)
+ * @return tablica z areny o rozmiarze @p prec ze współczynnikami odwrotności
+ */
+static mp_word_t *SeriesInverse(const mp_word_t h[], size_t hn, size_t prec) {
+    mp_word_t *g = WordAlloc(prec);
+    ArenaMark mark = ArenaSave();
+    mp_word_t *e = WordAlloc(2 * prec);
+    mp_word_t *prod = WordAlloc(3 * prec);
+    size_t t = 1;
+    g[0] = 1;
+
+    // Z g * h = 1 mod X^t dostajemy g * (2 - h * g) * h = 1 mod X^{2t}.
+    while (t < prec) {
+        size_t t2 = (2 * t < prec) ? 2 * t : prec;
+        size_t hLen = (hn < t2) ? hn : t2;
+
+        WordMul(h, hLen, g, t, prod);
+        memset(e, 0, sizeof(mp_word_t) * t2);
+
+        for (size_t i = 0; i < t2 && i < hLen + t - 1; ++i) {
+            e[i] = -prod[i];
+        }
+
+        e[0] += 2;
+
+        WordMul(g, t, e, t2, prod);
+        memcpy(g, prod, sizeof(mp_word_t) * t2);
+        t = t2;
+    }
+
+    ArenaRestore(mark);
+
+    return g;
+}
+
+/**
+ * Wylicza resztę z dzielenia wielomianu @p a przez wielomian unormowany @p d.
+ * @param[in] a : tablica współczynników dzielnej
+ * @param[in] na : rozmiar tablicy @p a
+ * @param[in] d : tablica współczynników dzielnika, `d[m] = 1`
+ * @param[in] m : stopień dzielnika (dodatni)
+ * @return tablica z areny o rozmiarze @p m ze współczynnikami reszty
+ */
+static mp_word_t *MonicRem(const mp_word_t a[], size_t na, const mp_word_t d[], size_t m) {
+    mp_word_t *r = WordAlloc(m);
+    ArenaMark mark = ArenaSave();
+
+    if (na <= m) {
+        memcpy(r, a, sizeof(mp_word_t) * na);
+        memset(r + na, 0, sizeof(mp_word_t) * (m - na));
+        return r;
+    }
+
+    size_t qn = na - m;
+
+    if (qn < MULTIPOINT_DIV_THRESHOLD || m < MULTIPOINT_DIV_THRESHOLD) {
+        mp_word_t *tmp = WordAlloc(na);
+        memcpy(tmp, a, sizeof(mp_word_t) * na);
+
+        for (size_t i = na; i-- > m;) {
+            mp_word_t c = tmp[i];
+
+            if (c) {
+                for (size_t j = 0; j < m; ++j) {
+                    tmp[i - m + j] -= c * d[j];
+                }
+            }
+        }
+
+        memcpy(r, tmp, sizeof(mp_word_t) * m);
+        ArenaRestore(mark);
+
+        return r;
+    }
+
+    // Iloraz odwróconych wielomianów to iloczyn odwróconej dzielnej
+    // i odwrotności odwróconego dzielnika modulo X^qn.
+    mp_word_t *rev = WordAlloc(m + 1);
+
+    for (size_t i = 0; i <= m; ++i) {
+        rev[i] = d[m - i];
+    }
+
+    mp_word_t *inv = SeriesInverse(rev, m + 1, qn);
+    mp_word_t *arev = WordAlloc(qn);
+    mp_word_t *prod = WordAlloc(qn + (qn > m ? qn : m + 1));
+
+    for (size_t i = 0; i < qn; ++i) {
+        arev[i] = a[na - 1 - i];
+    }
+
+    WordMul(arev, qn, inv, qn, prod);
+
+    for (size_t i = 0; i < qn; ++i) {
+        arev[i] = prod[qn - 1 - i];
+    }
+
+    WordMul(arev, qn, d, m + 1, prod);
+
+    for (size_t j = 0; j < m; ++j) {
+        r[j] = a[j] - prod[j];
+    }
+
+    ArenaRestore(mark);
+
+    return r;
+}
+
+/**
+ * Schodzi po drzewie iloczynów od wierzchołka @p idx na poziomie @p level,
+ * mając resztę @p r z dzielenia wielomianu przez wielomian tego wierzchołka,
+ * i zapisuje wartości w punktach liści do @p res.
+ * @param[in] levels : poziomy drzewa, poziom 0 to liście
+ * @param[in] sizes : liczby wierzchołków na poziomach
+ * @param[in] level : poziom wierzchołka
+ * @param[in] idx : indeks wierzchołka na poziomie
+ * @param[in] r : reszta o rozmiarze równym stopniowi wierzchołka
+ * @param[in] x : tablica punktów
+ * @param[out] res : tablica na wartości
+ */
+static void Descend(TreeNode *levels[], const size_t sizes[], unsigned level,
+                    size_t idx, const mp_word_t r[], const mp_word_t x[],
+                    mp_word_t res[]) {
+    const TreeNode *node = &levels[level][idx];
+
+    if (!level) {
+        for (size_t i = node->lo; i < node->hi; ++i) {
+            res[i] = Horner(r, node->deg, x[i]);
+        }
+
+        return;
+    }
+
+    for (size_t child = 2 * idx; child < 2 * idx + 2 && child < sizes[level - 1]; ++child) {
+        const TreeNode *c = &levels[level - 1][child];
+        ArenaMark mark = ArenaSave();
+        mp_word_t *rc = MonicRem(r, node->deg, c->c, c->deg);
+
+        Descend(levels, sizes, level - 1, child, rc, x, res);
+
+        ArenaRestore(mark);
+    }
+}
+
+/**
+ * Wylicza wartości wielomianu @p f w punktach @p x przy pomocy drzewa iloczynów.
+ * @param[in] f : tablica współczynników wielomianu
+ * @param[in] n : rozmiar tablicy @p f
+ * @param[in] x : tablica punktów
+ * @param[in] k : rozmiar tablicy @p x (dodatni)
+ * @param[out] res : tablica na wartości
+ */
+static void TreeEval(const mp_word_t f[], size_t n, const mp_word_t x[], size_t k,
+                     mp_word_t res[]) {
+    /**
+     * Ograniczenie na wysokość drzewa.
+     */
+    enum {MAX_LEVELS = 64};
+
+    ArenaMark mark = ArenaSave();
+    TreeNode *levels[MAX_LEVELS];
+    size_t sizes[MAX_LEVELS];
+    unsigned height = 0;
+
+    sizes[0] = (k + MULTIPOINT_LEAF_SIZE - 1) / MULTIPOINT_LEAF_SIZE;
+    levels[0] = ArenaAlloc(sizeof(TreeNode) * sizes[0]);
+
+    for (size_t j = 0; j < sizes[0]; ++j) {
+        TreeNode *leaf = &levels[0][j];
+        leaf->lo = j * MULTIPOINT_LEAF_SIZE;
+        leaf->hi = (leaf->lo + MULTIPOINT_LEAF_SIZE < k) ? leaf->lo + MULTIPOINT_LEAF_SIZE : k;
+        leaf->deg = leaf->hi - leaf->lo;
+        leaf->c = WordAlloc(leaf->deg + 1);
+        leaf->c[0] = 1;
+
+        // Mnożymy przez kolejne (X - x[i]).
+        for (size_t i = leaf->lo; i < leaf->hi; ++i) {
+            size_t len = i - leaf->lo + 1;
+            leaf->c[len] = leaf->c[len - 1];
+
+            for (size_t t = len - 1; t > 0; --t) {
+                leaf->c[t] = leaf->c[t - 1] - x[i] * leaf->c[t];
+            }
+
+            leaf->c[0] = -x[i] * leaf->c[0];
+        }
+    }
+
+    while (sizes[height] > 1) {
+        assert(height + 1 < MAX_LEVELS);
+        size_t size = (sizes[height] + 1) / 2;
+        TreeNode *next = ArenaAlloc(sizeof(TreeNode) * size);
+
+        for (size_t j = 0; j < size; ++j) {
+            const TreeNode *a = &levels[height][2 * j];
+            TreeNode *node = &next[j];
+
+            if (2 * j + 1 < sizes[height]) {
+                const TreeNode *b = &levels[height][2 * j + 1];
+                node->deg = a->deg + b->deg;
+                node->c = WordAlloc(node->deg + 1);
+                WordMul(a->c, a->deg + 1, b->c, b->deg + 1, node->c);
+                node->lo = a->lo;
+                node->hi = b->hi;
+            } else {
+                *node = *a;
+                node->c = WordAlloc(a->deg + 1);
+                memcpy(node->c, a->c, sizeof(mp_word_t) * (a->deg + 1));
+            }
+        }
+
+        ++height;
+        levels[height] = next;
+        sizes[height] = size;
+    }
+
+    const TreeNode *root = &levels[height][0];
+    mp_word_t *r = MonicRem(f, n, root->c, root->deg);
+
+    Descend(levels, sizes, height, 0, r, x, res);
+
+    ArenaRestore(mark);
+}
+
+void MultipointEval(const poly_coeff_t f[], size_t n, const poly_coeff_t x[],
+                    size_t k, poly_coeff_t res[]) {
+    const mp_word_t *wf = (const mp_word_t *)f;
+    const mp_word_t *wx = (const mp_word_t *)x;
+    mp_word_t *wres = (mp_word_t *)res;
+
+    if (k < MULTIPOINT_MIN_POINTS || n < MULTIPOINT_MIN_POINTS) {
+        for (size_t i = 0; i < k; ++i) {
+            wres[i] = Horner(wf, n, wx[i]);
+        }
+    } else {
+        // Drzewo większe niż stopień wielomianu nic nie zyskuje, więc punkty
+        // dzielimy na bloki rozmiaru n.
+        for (size_t i = 0; i < k; i += n) {
+            TreeEval(wf, n, wx + i, (k - i < n) ? k - i : n, wres + i);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/** @file
+   Interfejs wyliczania wartości wielomianu jednej zmiennej w wielu punktach
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __MULTIPOINT_H__
+#define __MULTIPOINT_H__
+
+#include <stddef.h>
+
+#include "poly.h"
+
+/**
+ * Najmniejsza liczba punktów i najmniejszy rozmiar wielomianu, przy których
+ * `MultipointEval` korzysta z drzewa iloczynów zamiast ze schematu Hornera
+ * w każdym punkcie osobno.
+ */
+#ifndef MULTIPOINT_MIN_POINTS
+#define MULTIPOINT_MIN_POINTS 256
+#endif
+
+/**
+ * Liczba punktów w liściu drzewa iloczynów. W liściach reszta z dzielenia
+ * jest wyliczana schematem Hornera.
+ */
+#ifndef MULTIPOINT_LEAF_SIZE
+#define MULTIPOINT_LEAF_SIZE 32
+#endif
+
+/**
+ * Próg stopnia dzielnika i ilorazu, poniżej którego reszta z dzielenia jest
+ * liczona metodą szkolną zamiast przez odwrotność szeregu potęgowego.
+ */
+#ifndef MULTIPOINT_DIV_THRESHOLD
+#define MULTIPOINT_DIV_THRESHOLD 64
+#endif
+
+/**
+ * Największa liczba wątków, między które `PolyAtMany` dzieli punkty.
+ * W testach jednostkowych alokacje przechodzą przez cmocka, która nie jest
+ * bezpieczna wielowątkowo, więc liczymy w jednym wątku.
+ */
+#ifndef AT_MANY_MAX_THREADS
+#ifdef UNIT_TESTING
+#define AT_MANY_MAX_THREADS 1
+#else
+#define AT_MANY_MAX_THREADS 8
+#endif
+#endif
+
+/**
+ * Najmniejsza praca (liczba punktów razy liczba współczynników liczbowych
+ * wielomianu) przypadająca na jeden wątek w `PolyAtMany`.
+ */
+#ifndef AT_MANY_MIN_WORK_PER_THREAD
+#define AT_MANY_MIN_WORK_PER_THREAD (1 << 16)
+#endif
+
+/**
+ * Wylicza wartości wielomianu gęstego zapisanego jako tablica współczynników
+ * (współczynnik przy `x^i` jest na pozycji `i`) w punktach `x[0], ...,
+ * x[k - 1]`.
+ * Dla dużej liczby punktów buduje drzewo iloczynów `(X - x[i])` i schodzi po
+ * nim resztami z dzielenia, co kosztuje @f$O(M(n) \log n)@f$ zamiast
+ * @f$O(nk)@f$. Arytmetyka jest modulo @f$2^{64}@f$; dzielimy tylko przez
+ * wielomiany unormowane, więc nie potrzebujemy odwrotności współczynników.
+ * @param[in] f : tablica współczynników wielomianu
+ * @param[in] n : rozmiar tablicy @p f (dodatni)
+ * @param[in] x : tablica punktów
+ * @param[in] k : rozmiar tablicy @p x
+ * @param[out] res : tablica o rozmiarze @p k na wartości `f(x[i])`
+ */
+void MultipointEval(const poly_coeff_t f[], size_t n, const poly_coeff_t x[],
+                    size_t k, poly_coeff_t res[]);
+
+#endif /* __MULTIPOINT_H__ */
@@ -0,0 +1,298 @@
+/** @file
+   Implementacja mnożenia wielomianów szybką transformatą teorioliczbową
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "ntt.h"
+#include "utils.h"
+
+/**
+ * Typ reszt modulo liczby pierwsze.
+ */
+typedef unsigned long ntt_word_t;
+
+/**
+ * Typ iloczynów reszt.
+ */
+typedef unsigned __int128 ntt_wide_t;
+
+/**
+ * Liczba pierwsza postaci @f$c \cdot 2^k + 1@f$ razem ze stałymi potrzebnymi
+ * do mnożenia Montgomery'ego (@f$R = 2^{64}@f$).
+ */
+typedef struct NttPrime {
+    ntt_word_t p; ///< liczba pierwsza mniejsza od @f$2^{62}@f$
+    ntt_word_t g; ///< pierwiastek pierwotny modulo `p`
+    unsigned k; ///< największe `k` takie, że @f$2^k@f$ dzieli `p - 1`
+    ntt_word_t pinv; ///< @f$-p^{-1} \bmod R@f$
+    ntt_word_t r2; ///< @f$R^2 \bmod p@f$
+} NttPrime;
+
+/**
+ * Liczba liczb pierwszych, modulo których liczymy transformaty.
+ * Iloczyn liczb pierwszych przekracza @f$2^{183}@f$, a współczynniki splotu
+ * reprezentantów z przedziału @f$[0, 2^{64})@f$ są mniejsze od
+ * @f$n \cdot 2^{128}@f$, więc odtwarzamy je dokładnie.
+ */
+#define NTT_PRIMES 3
+
+/**
+ * Liczby pierwsze wykorzystywane w transformatach. Stałe Montgomery'ego są
+ * wyliczane przy pierwszym użyciu.
+ */
+static NttPrime primes[NTT_PRIMES] = {
+    {.p = 4179340454199820289UL, .g = 3, .k = 57}, // 29 * 2^57 + 1
+    {.p = 1945555039024054273UL, .g = 5, .k = 56}, // 27 * 2^56 + 1
+    {.p = 2485986994308513793UL, .g = 5, .k = 55}  // 69 * 2^55 + 1
+};
+
+/**
+ * Oblicza `a * b * R^{-1} mod p` (redukcja Montgomery'ego).
+ * @param[in] a : reszta
+ * @param[in] b : reszta
+ * @param[in] pr : liczba pierwsza
+ * @return @f$a \cdot b \cdot R^{-1} \bmod p@f$
+ */
+static inline ntt_word_t MontMul(ntt_word_t a, ntt_word_t b, const NttPrime *pr) {
+    ntt_wide_t t = (ntt_wide_t)a * b;
+    ntt_word_t m = (ntt_word_t)t * pr->pinv;
+    ntt_word_t u = (ntt_word_t)((t + (ntt_wide_t)m * pr->p) >> 64);
+
+    return (u >= pr->p) ? u - pr->p : u;
+}
+
+/**
+ * Oblicza `a * b mod p` bez użycia postaci Montgomery'ego.
+ * @param[in] a : reszta
+ * @param[in] b : reszta
+ * @param[in] p : moduł
+ * @return @f$a \cdot b \bmod p@f$
+ */
+static ntt_word_t MulMod(ntt_word_t a, ntt_word_t b, ntt_word_t p) {
+    return (ntt_word_t)((ntt_wide_t)a * b % p);
+}
+
+/**
+ * Oblicza `base^exp mod p`.
+ * @param[in] base : podstawa
+ * @param[in] exp : wykładnik
+ * @param[in] p : moduł
+ * @return @f$base^{exp} \bmod p@f$
+ */
+static ntt_word_t PowMod(ntt_word_t base, ntt_word_t exp, ntt_word_t p) {
+    ntt_word_t result = 1;
+    base %= p;
+
+    while (exp) {
+        if (exp & 1) {
+            result = MulMod(result, base, p);
+        }
+
+        base = MulMod(base, base, p);
+        exp >>= 1;
+    }
+
+    return result;
+}
+
+/**
+ * Wylicza stałe Montgomery'ego dla liczby pierwszej @p pr.
+ * @param[in,out] pr : liczba pierwsza
+ */
+static void NttPrimeInit(NttPrime *pr) {
+    if (pr->pinv) {
+        return;
+    }
+
+    ntt_word_t inv = pr->p;
+
+    // Iteracja Newtona podwaja liczbę poprawnych bitów odwrotności.
+    for (int j = 0; j < 6; ++j) {
+        inv *= 2 - pr->p * inv;
+    }
+
+    pr->pinv = -inv;
+
+    ntt_word_t r = (ntt_word_t)(((ntt_wide_t)1 << 64) % pr->p);
+    pr->r2 = MulMod(r, r, pr->p);
+}
+
+/**
+ * Wypełnia tablicę @p roots kolejnymi potęgami `w^j` (w postaci
+ * Montgomery'ego) dla `j < half`.
+ * @param[out] roots : tablica o rozmiarze @p half
+ * @param[in] half : rozmiar tablicy
+ * @param[in] w : pierwiastek z jedynki
+ * @param[in] pr : liczba pierwsza
+ */
+static void FillRoots(ntt_word_t roots[], size_t half, ntt_word_t w, const NttPrime *pr) {
+    ntt_word_t wMont = MontMul(w, pr->r2, pr);
+    roots[0] = MontMul(1, pr->r2, pr);
+
+    for (size_t j = 1; j < half; ++j) {
+        roots[j] = MontMul(roots[j - 1], wMont, pr);
+    }
+}
+
+/**
+ * Transformata w przód (Gentleman-Sande) tablicy @p a o rozmiarze @p len.
+ * Wynik jest w porządku odwróconych bitów.
+ * @param[in,out] a : tablica reszt
+ * @param[in] len : rozmiar tablicy, potęga dwójki
+ * @param[in] roots : potęgi pierwiastka z jedynki rzędu @p len
+ * @param[in] pr : liczba pierwsza
+ */
+static void NttForward(ntt_word_t a[], size_t len, const ntt_word_t roots[],
+                       const NttPrime *pr) {
+    ntt_word_t p = pr->p;
+
+    for (size_t size = len; size >= 2; size >>= 1) {
+        size_t half = size / 2;
+        size_t step = len / size;
+
+        for (size_t i = 0; i < len; i += size) {
+            for (size_t j = 0; j < half; ++j) {
+                ntt_word_t u = a[i + j];
+                ntt_word_t v = a[i + j + half];
+                ntt_word_t sum = u + v;
+
+                a[i + j] = (sum >= p) ? sum - p : sum;
+                a[i + j + half] = MontMul((u >= v) ? u - v : u + p - v,
+                                          roots[j * step], pr);
+            }
+        }
+    }
+}
+
+/**
+ * Transformata odwrotna (Cooley-Tukey) bez dzielenia przez @p len tablicy @p a
+ * w porządku odwróconych bitów. Wynik jest w naturalnym porządku.
+ * @param[in,out] a : tablica reszt
+ * @param[in] len : rozmiar tablicy, potęga dwójki
+ * @param[in] roots : potęgi odwrotności pierwiastka z jedynki rzędu @p len
+ * @param[in] pr : liczba pierwsza
+ */
+static void NttInverse(ntt_word_t a[], size_t len, const ntt_word_t roots[],
+                       const NttPrime *pr) {
+    ntt_word_t p = pr->p;
+
+    for (size_t size = 2; size <= len; size <<= 1) {
+        size_t half = size / 2;
+        size_t step = len / size;
+
+        for (size_t i = 0; i < len; i += size) {
+            for (size_t j = 0; j < half; ++j) {
+                ntt_word_t u = a[i + j];
+                ntt_word_t v = MontMul(a[i + j + half], roots[j * step], pr);
+                ntt_word_t sum = u + v;
+
+                a[i + j] = (sum >= p) ? sum - p : sum;
+                a[i + j + half] = (u >= v) ? u - v : u + p - v;
+            }
+        }
+    }
+}
+
+/**
+ * Liczy splot tablic @p a i @p b modulo liczba pierwsza @p pr.
+ * @param[in] a : tablica współczynników
+ * @param[in] n : rozmiar tablicy @p a
+ * @param[in] b : tablica współczynników
+ * @param[in] m : rozmiar tablicy @p b
+ * @param[in] len : rozmiar transformaty, potęga dwójki nie mniejsza niż `n + m - 1`
+ * @param[in] pr : liczba pierwsza
+ * @param[out] fa : tablica o rozmiarze @p len, na początku której zapisywany jest
+ * splot
+ * @param[in] fb : tablica pomocnicza o rozmiarze @p len
+ * @param[in] roots : tablica pomocnicza o rozmiarze `len / 2`
+ */
+static void NttConvolve(const ntt_word_t a[], size_t n, const ntt_word_t b[],
+                        size_t m, size_t len, const NttPrime *pr, ntt_word_t fa[],
+                        ntt_word_t fb[], ntt_word_t roots[]) {
+    for (size_t i = 0; i < len; ++i) {
+        fa[i] = (i < n) ? a[i] % pr->p : 0;
+        fb[i] = (i < m) ? b[i] % pr->p : 0;
+    }
+
+    ntt_word_t w = PowMod(pr->g, (pr->p - 1) / len, pr->p);
+    FillRoots(roots, len / 2, w, pr);
+    NttForward(fa, len, roots, pr);
+    NttForward(fb, len, roots, pr);
+
+    // Iloczyn punktowy daje dodatkowy czynnik R^{-1}, a transformata odwrotna
+    // czynnik len; obydwa znosimy mnożąc na końcu przez R^2 / len.
+    for (size_t i = 0; i < len; ++i) {
+        fa[i] = MontMul(fa[i], fb[i], pr);
+    }
+
+    FillRoots(roots, len / 2, PowMod(w, pr->p - 2, pr->p), pr);
+    NttInverse(fa, len, roots, pr);
+
+    ntt_word_t scale = MulMod(PowMod(len, pr->p - 2, pr->p), pr->r2, pr->p);
+
+    for (size_t i = 0; i < n + m - 1; ++i) {
+        fa[i] = MontMul(fa[i], scale, pr);
+    }
+}
+
+void NttMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+            size_t m, poly_coeff_t res[]) {
+    size_t resLength = n + m - 1;
+    size_t len = 1;
+
+    while (len < resLength) {
+        len <<= 1;
+    }
+
+    for (int j = 0; j < NTT_PRIMES; ++j) {
+        NttPrimeInit(&primes[j]);
+        assert(len <= ((size_t)1 << primes[j].k));
+    }
+
+    ArenaMark mark = ArenaSave();
+    ntt_word_t *buffer = ArenaAlloc(sizeof(ntt_word_t) * ((NTT_PRIMES + 1) * len + len / 2 + 1));
+    ntt_word_t *scratch = buffer + NTT_PRIMES * len;
+    ntt_word_t *roots = scratch + len;
+    ntt_word_t *residues[NTT_PRIMES];
+
+    for (int j = 0; j < NTT_PRIMES; ++j) {
+        residues[j] = buffer + j * len;
+        NttConvolve((const ntt_word_t *)a, n, (const ntt_word_t *)b, m, len,
+                    &primes[j], residues[j], scratch, roots);
+    }
+
+    const NttPrime *p1 = &primes[0], *p2 = &primes[1], *p3 = &primes[2];
+
+    // Stałe algorytmu Garnera w postaci Montgomery'ego, żeby MontMul od razu
+    // dawał wynik w postaci zwykłej.
+    ntt_word_t inv1Mod2 = MontMul(PowMod(p1->p, p2->p - 2, p2->p), p2->r2, p2);
+    ntt_word_t p1Mod3 = MontMul(p1->p % p3->p, p3->r2, p3);
+    ntt_word_t inv12Mod3 = MontMul(PowMod(MulMod(p1->p, p2->p, p3->p), p3->p - 2, p3->p),
+                                   p3->r2, p3);
+    ntt_word_t p1p2 = p1->p * p2->p;
+
+    for (size_t i = 0; i < resLength; ++i) {
+        ntt_word_t t1 = residues[0][i];
+        ntt_word_t t1Mod2 = t1 % p2->p;
+        ntt_word_t r2 = residues[1][i];
+        ntt_word_t t2 = MontMul((r2 >= t1Mod2) ? r2 - t1Mod2 : r2 + p2->p - t1Mod2,
+                                inv1Mod2, p2);
+
+        ntt_word_t partial = t1 % p3->p + MontMul(t2 % p3->p, p1Mod3, p3);
+        partial = (partial >= p3->p) ? partial - p3->p : partial;
+        ntt_word_t r3 = residues[2][i];
+        ntt_word_t t3 = MontMul((r3 >= partial) ? r3 - partial : r3 + p3->p - partial,
+                                inv12Mod3, p3);
+
+        res[i] = (poly_coeff_t)(t1 + t2 * p1->p + t3 * p1p2);
+    }
+
+    ArenaRestore(mark);
+}
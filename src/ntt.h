@@ -0,0 +1,39 @@
+/** @file
+   Interfejs mnożenia wielomianów szybką transformatą teorioliczbową
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __NTT_H__
+#define __NTT_H__
+
+#include <stddef.h>
+
+#include "poly.h"
+
+/**
+ * Najmniejszy rozmiar mniejszego z czynników, przy którym `DenseMul` mnoży
+ * przy pomocy transformaty teorioliczbowej.
+ */
+#ifndef NTT_THRESHOLD
+#define NTT_THRESHOLD 2048
+#endif
+
+/**
+ * Mnoży dwa wielomiany gęste zapisane jako tablice współczynników
+ * (współczynnik przy `x^i` jest na pozycji `i`) przy pomocy transformaty
+ * teorioliczbowej modulo trzy 62-bitowe liczby pierwsze i chińskiego
+ * twierdzenia o resztach.
+ * Iloczyn jest dokładny modulo @f$2^{64}@f$, tak jak w `DenseMul`.
+ * @param[in] a : tablica współczynników pierwszego czynnika
+ * @param[in] n : rozmiar tablicy @p a (dodatni)
+ * @param[in] b : tablica współczynników drugiego czynnika
+ * @param[in] m : rozmiar tablicy @p b (dodatni)
+ * @param[out] res : tablica o rozmiarze `n + m - 1` na współczynniki iloczynu
+ */
+void NttMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+            size_t m, poly_coeff_t res[]);
+
+#endif /* __NTT_H__ */
@@ -10,48 +10,57 @@
 #include <stdio.h>
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <unistd.h>
 
+#include "allocator.h"
+#include "input.h"
 #include "parser.h"
 #include "polystack.h"
 #include "vector.h"
 #include "utils.h"
 
+// Stan parsera jest osobny dla każdego wątku, bo w trybie równoległym wątki
+// robocze parsują linie wielomianów jednocześnie z wątkiem głównym.
+
 /**
  * Obecny wiersz wejścia.
  */
-unsigned __row;
+_Thread_local unsigned __row;
 
 /**
  * Obecna kolumna wejścia.
  */
-unsigned __col;
+_Thread_local unsigned __col;
 
 /**
  * Zmienna przechowująca wynik pomyślnego parsowania współczynnika/punktu,
  * w którym wyliczamy wartość wielomianu.
  */
-poly_coeff_t __coeff;
+_Thread_local poly_coeff_t __coeff;
 
 /**
  * Zmienna przechowująca wynik pomyślengo parsowania wykładnika jednomianu.
  */
-poly_exp_t __exp;
+_Thread_local poly_exp_t __exp;
 
 /**
  * Zmienna przechowująca wynik pomyślnego parsowania indeksu zmiennej wielomianu.
  */
-unsigned __idx;
+_Thread_local unsigned __idx;
 
 /**
  * Ostatnio wczytany znak.
  */
-char __lastChar;
+_Thread_local char __lastChar;
 
 /**
  * Liczba nawiasów otwierających minus liczba nawiasów zamykających.
  */
-unsigned __brackets;
+_Thread_local unsigned __brackets;
 
 /**
  * Stany parsera wielomianu.
@@ -69,10 +78,10 @@ typedef enum ParsePolyState {LEFT_BRACKET, COEFFICIENT, COMMA, EXPONENT,
                              RIGHT_BRACKET, PLUS, QUICK_COEFF} ParsePolyState;
 
 /**
- * Wczytuje pojedynczy znak ze standardowego wejścia.
+ * Wczytuje pojedynczy znak z bufora standardowego wejścia.
  */
-void GetChar() {
-    __lastChar = (char)getchar();
+static inline void GetChar() {
+    __lastChar = (char)InputGetChar();
     ++__col;
 }
 
@@ -199,76 +208,127 @@ void PrintPolyError() {
     ReadUntilEndline();
 }
 
+#if PARSE_SWAR && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
 /**
- * Zwraca wynik próby sparsowania liczby typu `poly_coeff_t` pczynając od
- * obecnego znaku.
- * Funkcja wczytuje znaki ze standardowego wejścia do pierwszego nie pasującego
- * do typu `poly_coeff_t`.
- * @return czy udało się sparsować współczynnik/punkt, w którym wyliczamy
- * wartość wielomianu?
+ * Sprawdza, czy osiem kolejnych znaków wejścia to cyfry, i zamienia je na
+ * liczbę, traktując je jako jedno słowo 64-bitowe. Znaki muszą być już
+ * w buforze wejścia; nie są wczytywane.
+ * @param[out] value : liczba zapisana ośmioma cyframi
+ * @return czy osiem kolejnych znaków wejścia to cyfry?
  */
-bool IsCoeffParsed() {
-    /**
-     * Najmniejszy możliwy współczynnik.
-     */
-    static const char *MINCOEFF = "-9223372036854775808";
+static inline bool AreEightDigitsAhead(uint32_t *value) {
+    const char *ahead = InputAhead(8);
+    uint64_t chunk;
 
-    /**
-     * Największy możliwy współczynnik.
-     */
-    static const char *MAXCOEFF = "9223372036854775807";
-
-    /**
-     * Rozmiar tablicy `MINCOEFF`.
-     */
-    static const int MINCOEFF_SIZE = 21;
+    if (!ahead) {
+        return false;
+    }
 
-    char number[21] = "xxxxxxxxxxxxxxxxxxxx";
-    int numberSize = 1;
-    bool isNegative = IsMinus();
-    bool isZero = IsZero();
+    memcpy(&chunk, ahead, sizeof(chunk));
 
-    if (!IsDigit() && !IsMinus()) {
+    // Cyfry to bajty od 0x30 do 0x39: ich starsza połówka jest równa 3
+    // i pozostaje taka po dodaniu 6.
+    if ((chunk & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030
+        || ((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030) {
         return false;
     }
 
-    number[0] = __lastChar;
+    // Pierwsza cyfra jest w najmłodszym bajcie. Łączymy sąsiednie cyfry
+    // w liczby dwucyfrowe, potem czterocyfrowe i na końcu ośmiocyfrową.
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FF;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFF;
+    chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFF;
 
-    do {
-        GetChar();
+    *value = (uint32_t)chunk;
 
-        if (numberSize == 1 && isZero) {
-            __coeff = 0;
-            return true;
-        } else if (numberSize == 1 && isNegative) {
-            if (!IsDigit()) {
-                return false;
-            } else if (IsZero()) {
-                GetChar();
-                __coeff = 0;
-                return true;
-            }
-        } else if (!IsDigit()) {
-            break;
-        }
+    return true;
+}
+#endif
 
-        number[numberSize] = __lastChar;
-        ++numberSize;
-    } while (numberSize < MINCOEFF_SIZE - 2 + (int)isNegative);
+/**
+ * Wczytuje cyfry liczby zaczynającej się od obecnego znaku, który musi być
+ * niezerową cyfrą. Wczytuje co najwyżej @p maxDigits cyfr; dalsze znaki
+ * zostają na wejściu. Wartość liczona jest w jednym przebiegu, a po każdej
+ * cyfrze sprawdzamy, czy nie wyszła poza przedział `[min, max]`, więc przy
+ * niepowodzeniu obecnym znakiem jest cyfra, która go przekroczyła.
+ * @param[out] value : wczytana liczba pomnożona przez @p sign
+ * @param[in] sign : 1 albo -1
+ * @param[in] maxDigits : liczba cyfr liczby @p max (i @p min)
+ * @param[in] min : najmniejsza dopuszczalna wartość
+ * @param[in] max : największa dopuszczalna wartość
+ * @return czy liczba mieści się w przedziale `[min, max]`?
+ */
+static bool AreDigitsParsed(int64_t *value, int sign, int maxDigits, int64_t min,
+                            int64_t max) {
+    int64_t result = 0;
+    int digits = 0;
 
-    if (numberSize == MINCOEFF_SIZE - 2 + (int)isNegative) {
-        if ((isNegative && strncmp(number, MINCOEFF, MINCOEFF_SIZE - 1) > 0)
-                   || (!isNegative && strncmp(number, MAXCOEFF, MINCOEFF_SIZE - 2) > 0)) {
+    do {
+        if (__builtin_mul_overflow(result, 10, &result)
+            || __builtin_add_overflow(result, sign * (__lastChar - '0'), &result)
+            || result < min || result > max) {
             return false;
-        } else {
-            GetChar();
-            __coeff = atol(number);
-            return true;
         }
-    } else {
-        __coeff = atol(number);
+
+        ++digits;
+
+#if PARSE_SWAR && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint32_t eight;
+
+        // Liczba mająca mniej cyfr niż granice przedziału mieści się w nim,
+        // więc osiem cyfr naraz dopisujemy bez sprawdzania przepełnienia.
+        if (digits + 8 < maxDigits && AreEightDigitsAhead(&eight)) {
+            result = result * 100000000 + sign * (int64_t)eight;
+            digits += 8;
+            InputSkip(8);
+            __col += 8;
+        }
+#endif
+
+        GetChar();
+    } while (digits < maxDigits && IsDigit());
+
+    *value = result;
+
+    return true;
+}
+
+/**
+ * Zwraca wynik próby sparsowania liczby typu `poly_coeff_t` pczynając od
+ * obecnego znaku.
+ * Funkcja wczytuje znaki ze standardowego wejścia do pierwszego nie pasującego
+ * do typu `poly_coeff_t`.
+ * @return czy udało się sparsować współczynnik/punkt, w którym wyliczamy
+ * wartość wielomianu?
+ */
+bool IsCoeffParsed() {
+    /**
+     * Liczba cyfr największego i najmniejszego współczynnika.
+     */
+    static const int COEFF_DIGITS = 19;
+
+    int sign = 1;
+    int64_t value;
+
+    if (IsMinus()) {
+        GetChar();
+        sign = -1;
+    }
+
+    if (!IsDigit()) {
+        return false;
+    } else if (IsZero()) {
+        GetChar();
+        __coeff = 0;
         return true;
+    } else if (!AreDigitsParsed(&value, sign, COEFF_DIGITS, INT64_MIN, INT64_MAX)) {
+        return false;
     }
+
+    __coeff = value;
+
+    return true;
 }
 
 /**
@@ -279,79 +339,32 @@ bool IsCoeffParsed() {
  * gdy @p isUnsigned jest równe `false`, sparsowana liczba zapisywana jest do
  * zmiennej `__exp`.
  * @param[in] isUnsigned : czy parsować do zmiennej `__idx`
- * @return czy udało się sparsować współczynnik/punkt, w którym wyliczamy
- * wartość wielomianu?
+ * @return czy udało się sparsować współczynnik/punkt, w którym wyliczamy
+ * wartość wielomianu?
  */
 bool IsIntParsed(bool isUnsigned) {
     /**
-     * Największy możliwy wykładnik.
+     * Liczba cyfr największego wykładnika i największego indeksu zmiennej.
      */
-    static const char *MAXEXP = "2147483647";
+    static const int INT_DIGITS = 10;
 
-    /**
-     * Największy możliwy indeks zmiennej.
-     */
-    static const char *MAXIDX = "4294967295";
-
-    /**
-     * Rozmiar tablicy `MAXEXP` i `MAXIDX`.
-     */
-    static const int MAXINT_SIZE = 11;
-
-    char number[11] = "xxxxxxxxxx";
-    int numberSize = 1;
-    bool isZero = IsZero();
+    int64_t value = 0;
 
     if (!IsDigit()) {
         return false;
-    }
-
-    number[0] = __lastChar;
-
-    do {
+    } else if (IsZero()) {
         GetChar();
+    } else if (!AreDigitsParsed(&value, 1, INT_DIGITS, 0, isUnsigned ? UINT_MAX : INT_MAX)) {
+        return false;
+    }
 
-        if (numberSize == 1 && isZero) {
-            if (isUnsigned) {
-                __idx = 0;
-            } else {
-                __exp = 0;
-            }
-
-            return true;
-        } else if (!IsDigit()) {
-            break;
-        }
-
-        number[numberSize] = __lastChar;
-        ++numberSize;
-    } while (numberSize < MAXINT_SIZE - 1);
-
-    if (numberSize == MAXINT_SIZE - 1) {
-        if (isUnsigned && strncmp(number, MAXIDX, MAXINT_SIZE - 1) > 0) {
-            return false;
-        } else if (!isUnsigned && strncmp(number, MAXEXP, MAXINT_SIZE - 1) > 0) {
-            return false;
-        } else {
-            if (isUnsigned) {
-                __idx = (unsigned)strtoul(number, NULL, 10);
-            } else {
-                __exp = atoi(number);
-            }
-
-            GetChar();
-
-            return true;
-        }
+    if (isUnsigned) {
+        __idx = (unsigned)value;
     } else {
-        if (isUnsigned) {
-            __idx = (unsigned)strtoul(number, NULL, 10);
-        } else {
-            __exp = atoi(number);
-        }
-
-        return true;
+        __exp = (poly_exp_t)value;
     }
+
+    return true;
 }
 
 /**
@@ -376,108 +389,207 @@ bool IsExpParsed() {
  * Komendy akceptowane przez parser.
  */
 const char *COMMANDS[] = {"ZERO", "IS_COEFF", "IS_ZERO", "CLONE", "ADD", "MUL",
-                          "NEG", "SUB", "IS_EQ", "DEG", "DEG_BY ", "AT ",
-                          "PRINT", "POP", "COMPOSE "};
+                          "NEG", "SUB", "IS_EQ", "DEG", "DEG_BY ", "DEGS", "AT ",
+                          "PRINT", "POP", "COMPOSE ", "AT_MANY ", "AT_VARS ",
+                          "HASH_CONS", "HASH_STATS"};
 
 /**
  * Pozycje komend w tablicy `COMMANDS`.
  */
 enum ComPos {ZERO_POS, IS_COEFF_POS, IS_ZERO_POS, CLONE_POS, ADD_POS, MUL_POS,
-    NEG_POS, SUB_POS, IS_EQ_POS, DEG_POS, DEG_BY_POS, AT_POS,
-    PRINT_POS, POP_POS, COMPOSE_POS};
+    NEG_POS, SUB_POS, IS_EQ_POS, DEG_POS, DEG_BY_POS, DEGS_POS, AT_POS,
+    PRINT_POS, POP_POS, COMPOSE_POS, AT_MANY_POS, AT_VARS_POS,
+    HASH_CONS_POS, HASH_STATS_POS};
 
 /**
  * Liczba komend akceptowana przez parser.
  */
-const unsigned COMMANDS_SIZE = 15;
+#define COMMANDS_SIZE (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+_Static_assert(COMMANDS_SIZE <= UCHAR_MAX, "command positions must fit in unsigned char");
+
+/**
+ * Największa liczba węzłów drzewa prefiksowego komend; musi być nie mniejsza
+ * niż łączna długość nazw komend powiększona o 1.
+ */
+#define COMMAND_TRIE_MAX_NODES 128
 
 /**
- * Sprawdza czy @p s ma szansę być komendą.
- * @param[in] s : potencjalna komenda
- * @param[in] size : długość @p s
- * @return czy @p s jest prefiksem którejś z komend?
+ * Największa liczba różnych znaków występujących w nazwach komend.
  */
-bool IsCommandSubstr(const char *s, size_t size) {
+#define COMMAND_TRIE_MAX_CHARS 32
+
+/**
+ * Węzeł drzewa prefiksowego (trie) nazw komend.
+ */
+typedef struct CommandTrieNode {
+    /**
+     * Następniki węzła dla kolejnych klas znaków; 0 oznacza brak następnika.
+     */
+    unsigned char next[COMMAND_TRIE_MAX_CHARS];
+    unsigned char command; ///< pozycja komendy kończącej się w węźle albo `COMMANDS_SIZE`
+} CommandTrieNode;
+
+/**
+ * Drzewo prefiksowe nazw komend z tablicy `COMMANDS`; korzeniem jest węzeł 0.
+ */
+static CommandTrieNode commandTrie[COMMAND_TRIE_MAX_NODES];
+
+/**
+ * Klasy znaków: kolejne znaki występujące w nazwach komend mają klasy od 1,
+ * a pozostałe znaki klasę 0, która nie ma następników w żadnym węźle.
+ */
+static unsigned char commandCharClass[UCHAR_MAX + 1];
+
+/**
+ * Buduje drzewo prefiksowe komend z tablicy `COMMANDS`. Dodanie komendy
+ * wymaga więc jedynie dopisania jej nazwy do `COMMANDS` i pozycji do `ComPos`.
+ */
+static void CommandTrieInit() {
+    unsigned nodes = 1;
+    unsigned chars = 1;
+
+    memset(commandTrie, 0, sizeof(commandTrie));
+    memset(commandCharClass, 0, sizeof(commandCharClass));
+    commandTrie[0].command = COMMANDS_SIZE;
+
     for (unsigned j = 0; j < COMMANDS_SIZE; ++j) {
-        if (!strncmp(s, COMMANDS[j], size)) {
-            return true;
+        unsigned node = 0;
+
+        for (const char *c = COMMANDS[j]; *c; ++c) {
+            unsigned char *charClass = &commandCharClass[(unsigned char)*c];
+
+            if (!*charClass) {
+                assert(chars < COMMAND_TRIE_MAX_CHARS);
+                *charClass = (unsigned char)chars++;
+            }
+
+            if (!commandTrie[node].next[*charClass]) {
+                assert(nodes < COMMAND_TRIE_MAX_NODES);
+                commandTrie[nodes].command = COMMANDS_SIZE;
+                commandTrie[node].next[*charClass] = (unsigned char)nodes++;
+            }
+
+            node = commandTrie[node].next[*charClass];
         }
-    }
 
-    return false;
+        commandTrie[node].command = (unsigned char)j;
+    }
 }
 
 /**
- * Zwraca najmniejszy indeks `j` tablicy `COMMANDS` taki, że @p size jest równe
- * długości `COMMANDS[j]` i `strncmp(COMMANDS[j], s, size) == 0`, a jeśli
- * takowy nie istnieje, to zwracany jest rozmiar tablicy `COMMANDS`.
- * @param[in] s : potencjalna komenda
- * @param[in] size : rozmiar potencjalnej komendy
- * @return najmniejszy indeks `j` t. że `COMMANDS[j]` jest równe s
+ * Wczytuje nazwę komendy zaczynającą się od obecnego znaku, przechodząc po
+ * drzewie prefiksowym komend, dopóki kolejny znak przedłuża ścieżkę. Każdy
+ * znak jest więc czytany i sprawdzany tylko raz. Po powrocie obecnym znakiem
+ * jest pierwszy znak za najdłuższym prefiksem nazwy którejś z komend.
+ * @return pozycja komendy równej wczytanemu prefiksowi albo `COMMANDS_SIZE`,
+ * jeśli prefiks nie jest nazwą żadnej komendy
  */
-unsigned CommandPos(const char *s, size_t size) {
-    for (unsigned j = 0; j < COMMANDS_SIZE; ++j) {
-        if (size == strlen(COMMANDS[j]) && !strncmp(s, COMMANDS[j], size)) {
-            return j;
-        }
+static unsigned ScanCommand() {
+    unsigned node = 0;
+    unsigned next;
+
+    while ((next = commandTrie[node].next[commandCharClass[(unsigned char)__lastChar]])) {
+        node = next;
+        GetChar();
     }
 
-    return COMMANDS_SIZE;
+    return commandTrie[node].command;
 }
 
 /**
- * Przetwarza pojedynczą linię ze standardowego wejścia jako komendę
- * kalkulatora.
+ * Parsuje argumenty komend `AT_MANY` i `AT_VARS`: liczbę wartości `k` i `k`
+ * wartości oddzielonych spacjami, kończące linię.
+ * Niepoprawna liczba wartości daje błąd `WRONG COUNT`, a niepoprawna,
+ * brakująca lub nadmiarowa wartość błąd `WRONG VALUE`.
+ * @param[out] count : liczba wartości
+ * @return tablica wartości z areny, ważna do końca przetwarzania linii, albo
+ * NULL, jeśli wystąpił błąd (wtedy komunikat o błędzie jest już wypisany)
  */
-void ParseCommand() {
-    char com[10] = "xxxxxxxx";
-    com[0] = __lastChar;
-    unsigned charCount = 1;
+poly_coeff_t *ParseValueList(unsigned *count) {
+    if (!IsIdxParsed() || (__lastChar != ' ' && !IsLineFinished())) {
+        PrintCommandError(WRONG_COUNT);
+        return NULL;
+    }
 
-    while (IsCommandSubstr(com, charCount) && CommandPos(com, charCount) == COMMANDS_SIZE) {
+    *count = __idx;
+    unsigned size = 0, maxSize = 16;
+    poly_coeff_t *values = ArenaAlloc(sizeof(poly_coeff_t) * maxSize);
+
+    while (__lastChar == ' ' && size < *count) {
         GetChar();
-        com[charCount] = __lastChar;
-        ++charCount;
+
+        if (!IsCoeffParsed()) {
+            break;
+        }
+
+        if (size == maxSize) {
+            poly_coeff_t *newValues = ArenaAlloc(sizeof(poly_coeff_t) * 2 * maxSize);
+            memcpy(newValues, values, sizeof(poly_coeff_t) * maxSize);
+            values = newValues;
+            maxSize *= 2;
+        }
+
+        values[size] = __coeff;
+        ++size;
     }
 
-    unsigned pos;
+    if (size < *count || !IsLineFinished()) {
+        PrintCommandError(WRONG_VALUE);
+        return NULL;
+    }
 
-    if (!IsCommandSubstr(com, charCount)) {
-        PrintCommandError(WRONG_COMMAND);
-        return;
-    } else if (CommandPos(com, charCount) == DEG_POS) {
-        GetChar();
+    return values;
+}
 
-        if (IsLineFinished()) {
-            pos = DEG_POS;
-        } else if (__lastChar != '_') {
-            PrintCommandError(WRONG_COMMAND);
-            return;
-        } else {
-            com[charCount] = __lastChar;
-            ++charCount;
+/**
+ * Przetwarza argumenty komendy `AT_MANY` i wylicza wartości wielomianu ze
+ * szczytu stosu w podanych punktach.
+ */
+void ParseAtMany() {
+    unsigned count;
+    poly_coeff_t *points = ParseValueList(&count);
 
-            while (IsCommandSubstr(com, charCount) && CommandPos(com, charCount) == COMMANDS_SIZE) {
-                GetChar();
-                com[charCount] = __lastChar;
-                ++charCount;
-            }
+    if (points == NULL) {
+        return;
+    } else if (StackIsEmpty()) {
+        PrintCommandError(STACK_UNDERFLOW);
+    } else {
+        StackAtMany(count, points);
+    }
+}
 
-            if (!IsCommandSubstr(com, charCount)) {
-                PrintCommandError(WRONG_COMMAND);
-                return;
-            } else {
-                pos = DEG_BY_POS;
-            }
+/**
+ * Przetwarza argumenty komendy `AT_VARS` i wylicza wartość wielomianu ze
+ * szczytu stosu po podstawieniu podanych wartości pod kolejne zmienne.
+ */
+void ParseAtVars() {
+    unsigned count;
+    poly_coeff_t *values = ParseValueList(&count);
 
-        }
+    if (values == NULL) {
+        return;
+    } else if (StackIsEmpty()) {
+        PrintCommandError(STACK_UNDERFLOW);
     } else {
-        pos = CommandPos(com, charCount);
+        StackAtVars(count, values);
     }
+}
 
-    if (__lastChar == ' ') {
-        GetChar();
+/**
+ * Przetwarza pojedynczą linię ze standardowego wejścia jako komendę
+ * kalkulatora.
+ */
+void ParseCommand() {
+    unsigned pos = ScanCommand();
 
+    if (pos == COMMANDS_SIZE) {
+        PrintCommandError(WRONG_COMMAND);
+        return;
+    }
+
+    // Nazwy komend z argumentem kończą się spacją, która już została wczytana.
+    if (COMMANDS[pos][strlen(COMMANDS[pos]) - 1] == ' ') {
         switch (pos) {
             case DEG_BY_POS:
                 if (IsIdxParsed()) {
@@ -518,15 +630,17 @@ void ParseCommand() {
                     PrintCommandError(WRONG_COUNT);
                 }
                 break;
+            case AT_MANY_POS:
+                ParseAtMany();
+                break;
+            case AT_VARS_POS:
+                ParseAtVars();
+                break;
             default:
                 assert(false);
                 return;
         }
     } else {
-        if (pos != DEG_POS) {
-            GetChar();
-        }
-
         if (!IsLineFinished()) {
             PrintCommandError(WRONG_COMMAND);
             return;
@@ -609,6 +723,14 @@ void ParseCommand() {
                 }
                 break;
 
+            case DEGS_POS:
+                if (!StackSize()) {
+                    PrintCommandError(STACK_UNDERFLOW);
+                } else {
+                    StackPrintDegs();
+                }
+                break;
+
             case PRINT_POS:
                 if (!StackSize()) {
                     PrintCommandError(STACK_UNDERFLOW);
@@ -626,6 +748,14 @@ void ParseCommand() {
                 }
                 break;
 
+            case HASH_CONS_POS:
+                StackHashCons();
+                break;
+
+            case HASH_STATS_POS:
+                StackPrintInternStats();
+                break;
+
             default:
                 assert(false);
                 return;
@@ -639,15 +769,18 @@ void ParseCommand() {
  * typu `ParsePolyState`, stanami początkowymi są stany `LEFT_BRACKET`,
  * `COEFFICIENT` i `QUICK_COEFF`, stanami końcowymi są stany `LEFT_BRACKET`,
  * `COEFFICIENT` i `QUICK_COEFF`.
+ * Funkcja nie wypisuje błędów ani nie zmienia stosu, więc mogą ją wołać wątki
+ * robocze; przy błędzie obecny znak i `__col` wskazują miejsce błędu.
+ * @param[out] result : wielomian z linii, jeśli udało się go sparsować
+ * @return czy linia zawiera poprawny wielomian?
  */
-void ParsePolynomial() {
+bool ParsePolynomial(Poly *result) {
     __col = 1;
     ParsePolyState state;
     __brackets = 0;
 
     if (!IsLeftBracket() && !IsMinus() && !IsDigit()) {
-        PrintPolyError();
-        return;
+        return false;
     }
 
     state = (IsLeftBracket()) ? LEFT_BRACKET : QUICK_COEFF;
@@ -663,14 +796,12 @@ void ParsePolynomial() {
                 ParseVectorNewLayer();
 
                 if (!IsLeftBracket() && !IsMinus() && !IsDigit()) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else if (IsLeftBracket()) {
                     __brackets++;
                     GetChar();
                 } else if (!IsCoeffParsed()) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else {
                     state = COEFFICIENT;
                 }
@@ -678,8 +809,7 @@ void ParsePolynomial() {
 
             case COEFFICIENT:
                 if (!IsComma() || !__brackets) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else {
                     state = COMMA;
                     GetChar();
@@ -688,11 +818,9 @@ void ParsePolynomial() {
 
             case COMMA:
                 if (!IsDigit()) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else if (!IsExpParsed()) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else {
                     state = EXPONENT;
                 }
@@ -700,8 +828,7 @@ void ParsePolynomial() {
 
             case EXPONENT:
                 if (!IsRightBracket()) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else {
                     ParseVectorPolyAddMonos(__coeff, __exp);
                     --__brackets;
@@ -712,12 +839,10 @@ void ParsePolynomial() {
 
             case RIGHT_BRACKET:
                 if (!IsComma() && !IsPlus() && !IsLineFinished()) {
-                    PrintPolyError();
-                    return;
+                    return false;
                 } else if (IsComma()) {
                     if (__brackets == 0) {
-                        PrintPolyError();
-                        return;
+                        return false;
                     } else {
                         state = COMMA;
                         GetChar();
@@ -727,11 +852,11 @@ void ParsePolynomial() {
                     GetChar();
                 } else {
                     if (__brackets > 0) {
-                        PrintPolyError();
-                    } else {
-                        StackPush(ParseVectorResult());
+                        return false;
                     }
-                    return;
+
+                    *result = ParseVectorResult();
+                    return true;
                 }
                 break;
 
@@ -741,22 +866,17 @@ void ParsePolynomial() {
                     state = LEFT_BRACKET;
                     GetChar();
                 } else {
-                    PrintPolyError();
-                    return;
+                    return false;
                 }
                 break;
 
             case QUICK_COEFF:
-                if (IsCoeffParsed()) {
-                    if (IsLineFinished()) {
-                        StackPush(PolyFromCoeff(__coeff));
-                    } else {
-                        PrintPolyError();
-                    }
-                } else {
-                    PrintPolyError();
+                if (!IsCoeffParsed() || !IsLineFinished()) {
+                    return false;
                 }
-                return;
+
+                *result = PolyFromCoeff(__coeff);
+                return true;
         }
     }
 }
@@ -766,6 +886,7 @@ void ParsePolynomial() {
  * Funkcja najpierw próbuje przetworzyć linijkę jako polecenie kalkulatora,
  * a jeśli to nie wyjdzie, to następuje próba przetworzenia jej jako wielomianu.
  * Jeśli zaś ostatnim wczytanym znakiem był EOF, to funkcja nic nie robi.
+ * Po przetworzeniu linii zwalnia całą pamięć tymczasową z areny.
  */
 void ParseLine() {
     __col = 0;
@@ -777,24 +898,287 @@ void ParseLine() {
     } else if (isalpha(__lastChar)) {
         ParseCommand();
     } else {
+        Poly p;
+
         ParseVectorInit();
 
-        ParsePolynomial();
+        if (ParsePolynomial(&p)) {
+            StackPush(p);
+        } else {
+            PrintPolyError();
+        }
 
         ParseVectorClear();
     }
 
+    ArenaReset();
+    ++__row;
+}
+
+/**
+ * Linia wielomianu parsowana przez wątek roboczy.
+ */
+typedef struct LiteralJob {
+    const char *begin; ///< początek linii
+    const char *end; ///< koniec linii razem ze znakiem końca linii
+    Poly p; ///< sparsowany wielomian, jeśli linia jest poprawna
+    unsigned col; ///< kolumna błędu, jeśli linia nie jest poprawna
+    bool parsed; ///< czy linia zawiera poprawny wielomian
+    bool done; ///< czy linia została już sparsowana
+} LiteralJob;
+
+/**
+ * Wspólny stan wątku głównego i wątków roboczych parsowania równoległego.
+ */
+typedef struct ParallelParse {
+    LiteralJob *jobs; ///< długie linie wielomianów w kolejności na wejściu
+    size_t count; ///< liczba linii w `jobs`
+    size_t next; ///< pierwsza linia, której nie wziął jeszcze żaden wątek
+    size_t consumed; ///< liczba linii, których wyniki wykorzystał wątek główny
+    size_t lookahead; ///< o ile linii wątki robocze mogą wyprzedzić wątek główny
+    pthread_mutex_t mutex; ///< chroni pola `next`, `consumed` i `LiteralJob::done`
+    pthread_cond_t workCond; ///< budzi wątki robocze, gdy mogą wziąć linię
+    pthread_cond_t doneCond; ///< budzi wątek główny, gdy linia jest sparsowana
+} ParallelParse;
+
+/**
+ * Zapisuje w tablicy długie linie wielomianów z fragmentu wejścia
+ * `[begin, end)`: linie mające co najmniej `PARSE_PARALLEL_MIN_LINE` bajtów,
+ * których pierwszy znak nie jest literą.
+ * @param[in] begin : początek fragmentu wejścia
+ * @param[in] end : koniec fragmentu wejścia
+ * @param[out] count : liczba linii
+ * @return tablica linii z puli albo NULL, jeśli nie ma długich linii
+ */
+static LiteralJob *IndexLiteralLines(const char *begin, const char *end, size_t *count) {
+    LiteralJob *jobs = NULL;
+    size_t capacity = 0;
+
+    *count = 0;
+
+    for (const char *line = begin; line < end; ) {
+        const char *newline = memchr(line, '\n', (size_t)(end - line));
+        const char *next = newline ? newline + 1 : end;
+
+        if ((size_t)(next - line) >= PARSE_PARALLEL_MIN_LINE && !isalpha((unsigned char)*line)) {
+            if (*count == capacity) {
+                capacity = capacity ? 2 * capacity : 16;
+                jobs = PoolRealloc(jobs, sizeof(LiteralJob) * capacity);
+            }
+
+            jobs[(*count)++] = (LiteralJob) {.begin = line, .end = next, .done = false};
+        }
+
+        line = next;
+    }
+
+    return jobs;
+}
+
+/**
+ * Parsuje linię wielomianu @p job w bieżącym wątku i zapisuje wynik w @p job.
+ * Nie zmienia pozycji wejścia bieżącego wątku.
+ * @param[in,out] job : linia wielomianu
+ */
+static void ParseLiteralJob(LiteralJob *job) {
+    const char *cursor = __inputCursor;
+    const char *end = __inputEnd;
+
+    InputSetRange(job->begin, job->end);
+    __col = 0;
+    GetChar();
+
+    ParseVectorInit();
+    job->parsed = ParsePolynomial(&job->p);
+    job->col = __col;
+    ParseVectorClear();
+
+    ArenaReset();
+    InputSetRange(cursor, end);
+}
+
+/**
+ * Funkcja wątku roboczego: parsuje kolejne linie wielomianów, dopóki nie
+ * wyprzedzą wątku głównego o `ParallelParse::lookahead` linii.
+ * @param[in,out] arg : wspólny stan parsowania (`ParallelParse`)
+ * @return NULL
+ */
+static void *ParseWorker(void *arg) {
+    ParallelParse *pp = arg;
+
+    pthread_mutex_lock(&pp->mutex);
+
+    while (true) {
+        while (pp->next < pp->count && pp->next >= pp->consumed + pp->lookahead) {
+            pthread_cond_wait(&pp->workCond, &pp->mutex);
+        }
+
+        if (pp->next >= pp->count) {
+            break;
+        }
+
+        LiteralJob *job = &pp->jobs[pp->next++];
+
+        pthread_mutex_unlock(&pp->mutex);
+        ParseLiteralJob(job);
+        pthread_mutex_lock(&pp->mutex);
+
+        job->done = true;
+        pthread_cond_broadcast(&pp->doneCond);
+    }
+
+    pthread_mutex_unlock(&pp->mutex);
+    AllocThreadRelease();
+
+    return NULL;
+}
+
+/**
+ * Przetwarza w wątku głównym linię wielomianu @p job zaczynającą się na
+ * obecnej pozycji wejścia tak jak `ParseLine`, ale zamiast parsować linię
+ * bierze wynik wątku roboczego. Jeśli żaden wątek nie wziął jeszcze tej
+ * linii, parsuje ją sam.
+ * @param[in,out] pp : wspólny stan parsowania
+ * @param[in,out] job : linia wielomianu
+ */
+static void ApplyLiteralJob(ParallelParse *pp, LiteralJob *job) {
+    pthread_mutex_lock(&pp->mutex);
+
+    if (pp->next == (size_t)(job - pp->jobs)) {
+        ++pp->next;
+        pthread_mutex_unlock(&pp->mutex);
+        ParseLiteralJob(job);
+        pthread_mutex_lock(&pp->mutex);
+        job->done = true;
+    }
+
+    while (!job->done) {
+        pthread_cond_wait(&pp->doneCond, &pp->mutex);
+    }
+
+    ++pp->consumed;
+    pthread_cond_broadcast(&pp->workCond);
+    pthread_mutex_unlock(&pp->mutex);
+
+    InputSkip((size_t)(job->end - job->begin));
+    __lastChar = (job->end[-1] == '\n') ? '\n' : EOF;
+
+    if (job->parsed) {
+        StackPush(job->p);
+    } else {
+        __col = job->col;
+        PrintPolyError();
+    }
+
+    // Wielomiany przydzielone przez wątki robocze zwalnia wątek główny;
+    // oddajemy im zwolnione bloki, żeby nie wycinały ciągle nowych płyt.
+    PoolShareFreeBlocks();
+    ArenaReset();
     ++__row;
 }
 
+/**
+ * Przetwarza całe wejście, parsując długie linie wielomianów w wątkach
+ * roboczych. Wątek główny przechodzi wejście linia po linii jak przy
+ * parsowaniu w jednym wątku, ale w miejscu długiej linii wielomianu bierze
+ * wynik wątku roboczego.
+ * @return czy wejście zostało przetworzone; `false`, jeśli nie jest
+ * odwzorowane w pamięci, nie ma w nim długich linii albo jest tylko jeden
+ * procesor
+ */
+static bool ParseParallel() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threadCount = PARSE_MAX_THREADS;
+
+    if (cpus > 0 && (size_t)cpus < threadCount) {
+        threadCount = (size_t)cpus;
+    }
+
+    if (threadCount < 2 || !InputIsMapped()) {
+        return false;
+    }
+
+    // Bajt 0xFF parser czyta jako EOF, więc dalszej części wejścia nie
+    // indeksujemy.
+    const char *stop = memchr(__inputCursor, 0xFF, (size_t)(__inputEnd - __inputCursor));
+
+    if (stop != NULL) {
+        InputSetRange(__inputCursor, stop);
+    }
+
+    ParallelParse pp;
+    pp.jobs = IndexLiteralLines(__inputCursor, __inputEnd, &pp.count);
+
+    if (!pp.count) {
+        return false;
+    }
+
+    size_t workerCount = (threadCount - 1 < pp.count) ? threadCount - 1 : pp.count;
+    pthread_t threads[PARSE_MAX_THREADS];
+    bool started[PARSE_MAX_THREADS];
+
+    pp.next = pp.consumed = 0;
+    pp.lookahead = PARSE_LOOKAHEAD_PER_THREAD * workerCount;
+    pthread_mutex_init(&pp.mutex, NULL);
+    pthread_cond_init(&pp.workCond, NULL);
+    pthread_cond_init(&pp.doneCond, NULL);
+
+    for (size_t t = 0; t < workerCount; ++t) {
+        started[t] = !pthread_create(&threads[t], NULL, ParseWorker, &pp);
+    }
+
+    size_t j = 0;
+
+    do {
+        if (j < pp.count && __inputCursor == pp.jobs[j].begin) {
+            ApplyLiteralJob(&pp, &pp.jobs[j++]);
+        } else {
+            ParseLine();
+        }
+    } while (!IsEOF());
+
+    // Wszystkie długie linie leżą przed końcem wejścia, więc wątki robocze
+    // nie mają już nic do zrobienia.
+    pthread_mutex_lock(&pp.mutex);
+    pp.next = pp.count;
+    pthread_cond_broadcast(&pp.workCond);
+    pthread_mutex_unlock(&pp.mutex);
+
+    for (size_t t = 0; t < workerCount; ++t) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    for (; j < pp.count; ++j) {
+        if (pp.jobs[j].done && pp.jobs[j].parsed) {
+            PolyDestroy(&pp.jobs[j].p);
+        }
+    }
+
+    pthread_cond_destroy(&pp.doneCond);
+    pthread_cond_destroy(&pp.workCond);
+    pthread_mutex_destroy(&pp.mutex);
+    PoolFree(pp.jobs);
+
+    return true;
+}
+
 void Parse() {
     StackInit();
+    InputInit();
+    CommandTrieInit();
 
     __row = 1;
 
-    do {
-        ParseLine();
-    } while (!IsEOF());
+    if (!ParseParallel()) {
+        do {
+            ParseLine();
+        } while (!IsEOF());
+    }
 
+    InputRelease();
     StackClear();
+    PolySetHashCons(false);
+    AllocRelease();
 }
\ No newline at end of file
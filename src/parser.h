@@ -9,8 +9,54 @@
 #ifndef __PARSER_H__
 #define __PARSER_H__
 
+/**
+ * Czy parser zamienia liczby na wartości po osiem cyfr naraz, jeśli kolejne
+ * cyfry są już w buforze wejścia. Przy wartości 0 każda cyfra jest
+ * przetwarzana osobno.
+ */
+#ifndef PARSE_SWAR
+#define PARSE_SWAR 1
+#endif
+
+/**
+ * Największa liczba wątków parsujących linie wielomianów, wliczając wątek
+ * główny. Równoległe parsowanie działa tylko wtedy, gdy standardowe wejście
+ * jest zwykłym plikiem odwzorowanym w pamięci. W testach jednostkowych
+ * alokacje przechodzą przez cmocka, która nie jest bezpieczna wielowątkowo,
+ * więc parsujemy w jednym wątku.
+ */
+#ifndef PARSE_MAX_THREADS
+#ifdef UNIT_TESTING
+#define PARSE_MAX_THREADS 1
+#else
+#define PARSE_MAX_THREADS 8
+#endif
+#endif
+
+/**
+ * Najmniejsza długość (w bajtach) linii wielomianu parsowanej przez wątek
+ * roboczy. Krótsze linie i wszystkie polecenia przetwarza wątek główny.
+ */
+#ifndef PARSE_PARALLEL_MIN_LINE
+#define PARSE_PARALLEL_MIN_LINE 4096
+#endif
+
+/**
+ * Liczba linii wielomianów na wątek roboczy, o które wątki robocze mogą
+ * wyprzedzić wątek główny. Ogranicza pamięć zajmowaną przez wielomiany
+ * sparsowane, ale jeszcze niewrzucone na stos.
+ */
+#ifndef PARSE_LOOKAHEAD_PER_THREAD
+#define PARSE_LOOKAHEAD_PER_THREAD 4
+#endif
+
 /**
  * Przetwarza całe standardowe wejście programu, linijka po linijce.
+ * Jeśli wejście jest zwykłym plikiem zawierającym długie linie wielomianów,
+ * linie te są parsowane z wyprzedzeniem przez wątki robocze, a polecenia
+ * i wrzucanie wielomianów na stos odbywają się w wątku głównym w kolejności
+ * linii, więc wyjście i komunikaty o błędach są takie same jak przy
+ * parsowaniu w jednym wątku.
  */
 void Parse();
 
@@ -7,45 +7,472 @@
 */
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "allocator.h"
+#include "densemul.h"
+#include "frozen.h"
+#include "multipoint.h"
 #include "poly.h"
+#include "power.h"
 #include "utils.h"
 
+_Static_assert(sizeof(Poly) == 12, "Poly is expected to take 12 bytes");
+_Static_assert(sizeof(Mono) == 16, "Mono is expected to take 16 bytes");
+
+/**
+ * Liczba alokacji pamięci wykonanych przez moduł od początku działania programu.
+ * Licznik jest atomowy, bo `PolyAtMany` alokuje z wielu wątków.
+ */
+static atomic_size_t allocCount = 0;
+
+/**
+ * Przydziela z puli @p size bajtów pamięci i zlicza alokację.
+ * Wywłaszcza program w przypadku niepowodzenia alokacji.
+ * @param[in] size : rozmiar pamięci w bajtach
+ * @return wskaźnik na zaalokowaną pamięć
+ */
+static void *PolyMalloc(size_t size) {
+    void *ptr = PoolAlloc(size);
+    atomic_fetch_add_explicit(&allocCount, 1, memory_order_relaxed);
+
+    return ptr;
+}
+
+/**
+ * Zmienia rozmiar pamięci z puli wskazywanej przez @p ptr na @p size bajtów
+ * i zlicza alokację, jeśli blok nie został na miejscu. Zmieniana tablica
+ * jednomianów traci metadane.
+ * Wywłaszcza program w przypadku niepowodzenia alokacji.
+ * @param[in] ptr : wskaźnik na pamięć
+ * @param[in] size : nowy rozmiar pamięci w bajtach
+ * @return wskaźnik na pamięć o nowym rozmiarze
+ */
+static void *PolyRealloc(void *ptr, size_t size) {
+    if (ptr != NULL) {
+        PoolFree(PoolTakeAux(ptr));
+    }
+
+    void *result = PoolRealloc(ptr, size);
+
+    if (result != ptr) {
+        atomic_fetch_add_explicit(&allocCount, 1, memory_order_relaxed);
+    }
+
+    return result;
+}
+
+/**
+ * Zwraca do puli pamięć zaalokowaną przez `PolyMalloc` albo `PolyRealloc`
+ * razem z metadanymi tablicy jednomianów (zob. `PolyMeta`).
+ * @param[in] ptr : wskaźnik na pamięć albo NULL
+ */
+static inline void PolyFree(void *ptr) {
+    if (ptr != NULL) {
+        PoolFree(PoolTakeAux(ptr));
+    }
+
+    PoolFree(ptr);
+}
+
+size_t PolyAllocCount() {
+    return atomic_load_explicit(&allocCount, memory_order_relaxed);
+}
+
+/**
+ * Znacznik bloku puli oznaczający tablicę jednomianów wpisaną do tablicy
+ * internowania. Taka tablica jest niezmienna i jest jedynym egzemplarzem
+ * wielomianu o swojej strukturze.
+ */
+#define POLY_INTERNED 1u
+
+/**
+ * Początkowa liczba miejsc w tablicy internowania (potęga dwójki).
+ */
+#define INTERN_INITIAL_CAPACITY 1024
+
+/**
+ * Wpis tablicy internowania.
+ */
+typedef struct InternEntry {
+    Mono *monos; ///< tablica jednomianów albo NULL dla wolnego miejsca
+    unsigned size; ///< rozmiar tablicy jednomianów
+    size_t hash; ///< płytki skrót wielomianu
+} InternEntry;
+
+/**
+ * Globalna tablica internowania z adresowaniem otwartym.
+ * Tablica nie jest właścicielem wpisów: tablicę jednomianów usuwa z niej jej
+ * ostatni właściciel przy zwalnianiu.
+ */
+static struct {
+    InternEntry *entries; ///< miejsca tablicy
+    size_t capacity; ///< liczba miejsc
+    size_t count; ///< liczba zajętych miejsc
+    size_t lookups; ///< liczba internowanych węzłów
+    size_t hits; ///< liczba węzłów zastąpionych istniejącym egzemplarzem
+} intern;
+
+/**
+ * Chroni tablicę internowania; wielomiany zwalniają też wątki `PolyAtMany`.
+ */
+static pthread_mutex_t internMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Czy wielomiany wstawiane na stos kalkulatora są internowane.
+ */
+static atomic_bool hashCons = false;
+
+/**
+ * Sprawdza, czy tablica jednomianów wielomianu @p p jest zinternowana.
+ * @param[in] p : wielomian
+ * @return czy @p p jest zinternowany?
+ */
+static inline bool PolyIsInterned(const Poly *p) {
+    return !PolyIsCoeff(p) && (PoolGetFlags(p->monos) & POLY_INTERNED);
+}
+
+/**
+ * Dołącza wartość @p v do skrótu @p h.
+ * @param[in] h : skrót
+ * @param[in] v : wartość
+ * @return nowy skrót
+ */
+static inline size_t HashCombine(size_t h, size_t v) {
+    h = (h ^ v) * 0x9e3779b97f4a7c15ul;
+
+    return h ^ (h >> 29);
+}
+
+/**
+ * Liczy płytki skrót wielomianu @p p niebędącego współczynnikiem.
+ * Współczynniki niebędące liczbami są reprezentowane przez adresy swoich
+ * tablic jednomianów, co wystarcza, gdy są już zinternowane.
+ * @param[in] p : wielomian
+ * @return skrót
+ */
+static size_t PolyShallowHash(const Poly *p) {
+    size_t h = p->size;
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        const Poly *c = &p->monos[j].p;
+        h = HashCombine(h, (size_t)p->monos[j].exp);
+        h = HashCombine(h, PolyIsCoeff(c) ? (size_t)c->coeff : (size_t)c->monos + 1);
+    }
+
+    return h;
+}
+
+/**
+ * Porównuje płytko tablice jednomianów @p a i @p b o rozmiarze @p size:
+ * współczynniki niebędące liczbami porównuje po adresach tablic.
+ * @param[in] a : tablica jednomianów
+ * @param[in] b : tablica jednomianów
+ * @param[in] size : rozmiar tablic
+ * @return czy tablice są płytko równe?
+ */
+static bool MonosShallowEq(const Mono a[], const Mono b[], unsigned size) {
+    for (unsigned j = 0; j < size; ++j) {
+        const Poly *p = &a[j].p, *q = &b[j].p;
+
+        // Pole `coeff` dzieli pamięć z `monos`, więc porównuje też adresy tablic.
+        if (a[j].exp != b[j].exp || p->size != q->size || p->coeff != q->coeff) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Szuka w tablicy internowania wpisu płytko równego tablicy @p monos.
+ * Wołana pod blokadą `internMutex`, gdy tablica ma wolne miejsca.
+ * @param[in] monos : tablica jednomianów
+ * @param[in] size : rozmiar tablicy jednomianów
+ * @param[in] hash : płytki skrót
+ * @return indeks znalezionego wpisu albo wolnego miejsca, w którym kończy się
+ * szukanie
+ */
+static size_t InternFind(const Mono monos[], unsigned size, size_t hash) {
+    size_t mask = intern.capacity - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const InternEntry *e = &intern.entries[i];
+
+        if (e->monos == NULL || (e->hash == hash && e->size == size
+                                 && MonosShallowEq(e->monos, monos, size))) {
+            return i;
+        }
+    }
+}
+
+/**
+ * Podwaja liczbę miejsc tablicy internowania.
+ * Wołana pod blokadą `internMutex`.
+ */
+static void InternGrow() {
+    InternEntry *old = intern.entries;
+    size_t oldCapacity = intern.capacity;
+
+    intern.capacity = oldCapacity ? 2 * oldCapacity : INTERN_INITIAL_CAPACITY;
+    intern.entries = calloc(intern.capacity, sizeof(InternEntry));
+    assert(intern.entries != NULL);
+
+    for (size_t j = 0; j < oldCapacity; ++j) {
+        if (old[j].monos != NULL) {
+            size_t i = old[j].hash & (intern.capacity - 1);
+
+            while (intern.entries[i].monos != NULL) {
+                i = (i + 1) & (intern.capacity - 1);
+            }
+
+            intern.entries[i] = old[j];
+        }
+    }
+
+    free(old);
+}
+
+/**
+ * Usuwa wpis @p i z tablicy internowania, przesuwając wstecz następujące po nim
+ * wpisy, żeby nie przerwać ciągów próbkowania.
+ * Wołana pod blokadą `internMutex`.
+ * @param[in] i : indeks wpisu
+ */
+static void InternRemove(size_t i) {
+    size_t mask = intern.capacity - 1;
+
+    for (size_t j = (i + 1) & mask; intern.entries[j].monos != NULL; j = (j + 1) & mask) {
+        size_t home = intern.entries[j].hash & mask;
+
+        // Wpis j można przenieść na miejsce i, jeśli i leży między jego
+        // pozycją początkową a j.
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            intern.entries[i] = intern.entries[j];
+            i = j;
+        }
+    }
+
+    intern.entries[i].monos = NULL;
+
+    if (!--intern.count) {
+        free(intern.entries);
+        intern.entries = NULL;
+        intern.capacity = 0;
+    }
+}
+
+/**
+ * Usuwa właściciela tablicy jednomianów wielomianu @p p niebędącego
+ * współczynnikiem. Ostatni właściciel zinternowanej tablicy usuwa ją z tablicy
+ * internowania pod blokadą, żeby nikt w tym czasie jej tam nie znalazł.
+ * @param[in] p : wielomian
+ * @return czy był to ostatni właściciel?
+ */
+static bool PolyRelease(const Poly *p) {
+    if (!PolyIsInterned(p)) {
+        return PoolRelease(p->monos);
+    }
+
+    pthread_mutex_lock(&internMutex);
+    bool last = PoolRelease(p->monos);
+
+    if (last) {
+        InternRemove(InternFind(p->monos, p->size, PolyShallowHash(p)));
+    }
+
+    pthread_mutex_unlock(&internMutex);
+
+    return last;
+}
+
 /**
- * Wywłaszcza program w przypadku niepowodzenia alokacji pamięci przydzielonej
- * wskaźnikowi @p ptr.
- * @param[in] ptr : wskaźnik, który powinien być różny od NULL;
+ * Zastępuje węzeł @p p, którego współczynniki są już zinternowane, jedynym
+ * egzemplarzem z tablicy internowania albo wpisuje go do niej.
+ * @param[in,out] p : wielomian niebędący współczynnikiem
  */
-static inline void CheckAllocation(const void *ptr) {
-    (void)ptr;
-    assert(ptr != NULL);
+static void PolyInternNode(Poly *p) {
+    size_t hash = PolyShallowHash(p);
+
+    pthread_mutex_lock(&internMutex);
+    ++intern.lookups;
+
+    if (intern.count + 1 > intern.capacity / 4 * 3) {
+        InternGrow();
+    }
+
+    size_t i = InternFind(p->monos, p->size, hash);
+    Mono *existing = intern.entries[i].monos;
+
+    if (existing != NULL) {
+        ++intern.hits;
+        PoolRetain(existing);
+        pthread_mutex_unlock(&internMutex);
+        PolyDestroy(p);
+        p->monos = existing;
+    } else {
+        intern.entries[i] = (InternEntry) {.monos = p->monos, .size = p->size, .hash = hash};
+        ++intern.count;
+        PoolSetFlags(p->monos, PoolGetFlags(p->monos) | POLY_INTERNED);
+        pthread_mutex_unlock(&internMutex);
+    }
+}
+
+void PolyIntern(Poly *p) {
+    if (PolyIsCoeff(p) || PolyIsInterned(p)) {
+        return;
+    }
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        PolyIntern(&p->monos[j].p);
+    }
+
+    PolyInternNode(p);
+}
+
+void PolySetHashCons(bool enabled) {
+    if (enabled && !atomic_load(&hashCons)) {
+        pthread_mutex_lock(&internMutex);
+        intern.lookups = intern.hits = 0;
+        pthread_mutex_unlock(&internMutex);
+    }
+
+    atomic_store(&hashCons, enabled);
+}
+
+bool PolyHashConsEnabled() {
+    return atomic_load_explicit(&hashCons, memory_order_relaxed);
+}
+
+PolyInternStats PolyGetInternStats() {
+    pthread_mutex_lock(&internMutex);
+    PolyInternStats stats = {.nodes = intern.count, .lookups = intern.lookups,
+                             .hits = intern.hits};
+    pthread_mutex_unlock(&internMutex);
+
+    return stats;
 }
 
 void PolyDestroy(Poly *p) {
-    if (!PolyIsCoeff(p)) {
+    if (!PolyIsCoeff(p) && PolyRelease(p)) {
         for (unsigned i = 0; i < p->size; ++i) {
             MonoDestroy(&p->monos[i]);
         }
 
-        free(p->monos);
+        PolyFree(p->monos);
     }
 }
 
 Poly PolyClone(const Poly *p) {
-    Poly res = (Poly) {.monos = NULL, .size = p->size, .coeff = p->coeff};
-
     if (!PolyIsCoeff(p)) {
-        res.monos = malloc(sizeof(Mono) * p->size);
-        CheckAllocation(res.monos);
-        
+        PoolRetain(p->monos);
+    }
+
+    return *p;
+}
+
+/**
+ * Zapewnia, że wielomian @p p jest jedynym właścicielem swojej tablicy
+ * jednomianów, więc można ją modyfikować. Współdzieloną tablicę zastępuje
+ * kopią, której jednomiany nadal współdzielą współczynniki z oryginałem.
+ * @param[in,out] p : wielomian
+ */
+static void PolyMakeUnique(Poly *p) {
+    if (PolyIsCoeff(p)) {
+        return;
+    } else if (PoolIsShared(p->monos) || PolyIsInterned(p)) {
+        Mono *monos = PolyMalloc(sizeof(Mono) * p->size);
+
         for (unsigned j = 0; j < p->size; ++j) {
-            Mono m = MonoClone(&p->monos[j]);
-            res.monos[j] = m;
+            monos[j] = MonoClone(&p->monos[j]);
+        }
+
+        PolyDestroy(p);
+        p->monos = monos;
+    } else {
+        // Tablica zaraz zostanie zmieniona, więc metadane się zdezaktualizują.
+        PoolFree(PoolTakeAux(p->monos));
+    }
+}
+
+/**
+ * Metadane węzła wielomianu niebędącego współczynnikiem. Są liczone przy
+ * pierwszym użyciu i zapamiętywane we wskaźniku pomocniczym bloku tablicy
+ * jednomianów, skąd usuwa je każda zmiana tablicy w miejscu.
+ */
+typedef struct PolyMeta {
+    size_t hash; ///< skrót strukturalny, równy dla równych wielomianów
+    size_t terms; ///< liczba jednomianów wielomianu po rozwinięciu
+    poly_exp_t deg; ///< stopień wielomianu
+    unsigned vars; ///< rozmiar tablicy `degs`
+    poly_exp_t degs[]; ///< stopnie ze względu na kolejne zmienne
+} PolyMeta;
+
+/**
+ * Zwraca metadane wielomianu @p p niebędącego współczynnikiem, wyliczając je
+ * w razie potrzeby (razem z metadanymi współczynników).
+ * Tablicę jednomianów mogą współdzielić wątki, więc wyliczone metadane są
+ * publikowane atomowo, a przegrany wyścig kończy się zwolnieniem kopii.
+ * @param[in] p : wielomian
+ * @return metadane
+ */
+static const PolyMeta *PolyGetMeta(const Poly *p) {
+    const PolyMeta *cached = PoolGetAux(p->monos);
+
+    if (cached != NULL) {
+        return cached;
+    }
+
+    unsigned vars = 1;
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        if (!PolyIsCoeff(&p->monos[j].p)) {
+            unsigned tmp = PolyGetMeta(&p->monos[j].p)->vars + 1;
+            vars = (tmp > vars) ? tmp : vars;
+        }
+    }
+
+    PolyMeta *meta = PolyMalloc(sizeof(PolyMeta) + sizeof(poly_exp_t) * vars);
+    memset(meta->degs, 0, sizeof(poly_exp_t) * vars);
+    meta->hash = p->size;
+    meta->terms = 0;
+    meta->deg = 0;
+    meta->vars = vars;
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        const Mono *m = &p->monos[j];
+        poly_exp_t deg = (m->exp < 0) ? 0 : m->exp;
+        meta->hash = HashCombine(meta->hash, (size_t)m->exp);
+        meta->degs[0] = (deg > meta->degs[0]) ? deg : meta->degs[0];
+
+        if (PolyIsCoeff(&m->p)) {
+            meta->hash = HashCombine(meta->hash, (size_t)m->p.coeff);
+            ++meta->terms;
+        } else {
+            const PolyMeta *c = PolyGetMeta(&m->p);
+            meta->hash = HashCombine(meta->hash, c->hash);
+            meta->terms += c->terms;
+            deg += c->deg;
+
+            for (unsigned i = 0; i < c->vars; ++i) {
+                meta->degs[i + 1] = (c->degs[i] > meta->degs[i + 1]) ? c->degs[i] : meta->degs[i + 1];
+            }
         }
+
+        meta->deg = (deg > meta->deg) ? deg : meta->deg;
+    }
+
+    if (!PoolPublishAux(p->monos, meta)) {
+        PolyFree(meta);
+        return PoolGetAux(p->monos);
     }
 
-    return res;
+    return meta;
 }
 
 bool PolyIsEq(const Poly *p, const Poly *q) {
@@ -55,6 +482,12 @@ bool PolyIsEq(const Poly *p, const Poly *q) {
         return p->coeff == q->coeff;
     } else if (p->size != q->size) {
         return false;
+    } else if (p->monos == q->monos) {
+        return true;
+    } else if (PolyIsInterned(p) && PolyIsInterned(q)) {
+        return false;
+    } else if (PolyGetMeta(p)->hash != PolyGetMeta(q)->hash) {
+        return false;
     } else {
         for (unsigned j = 0; j < p->size; ++j) {
             if (p->monos[j].exp != q->monos[j].exp) {
@@ -76,17 +509,56 @@ static void PolyNegRec(Poly *p) {
     if (PolyIsCoeff(p)) {
         p->coeff = -p->coeff;
     } else {
+        PolyMakeUnique(p);
+
         for (unsigned j = 0; j < p->size; ++j) {
             PolyNegRec(&p->monos[j].p);
         }
     }
 }
 
-Poly PolyNeg(const Poly *p) {
-    Poly result = PolyClone(p);
-    PolyNegRec(&result);
+/**
+ * Tworzy kopię wielomianu @p p pomnożoną przez stałą @p mult bez tworzenia
+ * pośredniej kopii. Jednomiany, które po pomnożeniu się zerują, są pomijane.
+ * Przy @p mult równym 1 wynik współdzieli tablicę jednomianów z @p p.
+ * @param[in] p : wielomian
+ * @param[in] mult : skalar
+ * @return `mult * p`
+ */
+static Poly PolyCloneScaled(const Poly *p, poly_coeff_t mult) {
+    if (PolyIsCoeff(p)) {
+        return PolyFromCoeff(p->coeff * mult);
+    } else if (mult == 1) {
+        return PolyClone(p);
+    }
 
-    return result;
+    Mono *monos = PolyMalloc(sizeof(Mono) * p->size);
+    unsigned newSize = 0;
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        Poly c = PolyCloneScaled(&p->monos[j].p, mult);
+
+        if (!PolyIsZero(&c)) {
+            monos[newSize++] = (Mono) {.p = c, .exp = p->monos[j].exp};
+        }
+    }
+
+    if (!newSize) {
+        PolyFree(monos);
+        return PolyFromCoeff(0);
+    } else if (newSize == 1 && monos[0].exp == -1) {
+        Poly c = monos[0].p;
+        PolyFree(monos);
+        return c;
+    } else if (newSize < p->size) {
+        monos = PolyRealloc(monos, sizeof(Mono) * newSize);
+    }
+
+    return (Poly) {.monos = monos, .size = newSize};
+}
+
+Poly PolyNeg(const Poly *p) {
+    return PolyCloneScaled(p, -1);
 }
 
 Poly PolySub(const Poly *p, const Poly *q) {
@@ -104,18 +576,9 @@ poly_exp_t PolyDegBy(const Poly *p, unsigned var_idx) {
     } else if (PolyIsCoeff(p)) {
         return 0;
     } else {
-        poly_exp_t result = 0;
-
-        if (var_idx) {
-            for (unsigned j = 0; j < p->size; ++j) {
-                poly_exp_t tmp = PolyDegBy(&p->monos[j].p, var_idx - 1);
-                result = (result < tmp) ? tmp : result;
-            }
-        } else if (result < p->monos[p->size - 1].exp) {
-            result = p->monos[p->size - 1].exp;
-        }
+        const PolyMeta *meta = PolyGetMeta(p);
 
-        return result;
+        return (var_idx < meta->vars) ? meta->degs[var_idx] : 0;
     }
 }
 
@@ -125,19 +588,16 @@ poly_exp_t PolyDeg(const Poly *p) {
     } else if (PolyIsCoeff(p)) {
         return 0;
     } else {
-        poly_exp_t result = 0;
-
-        for (unsigned j = 0; j < p->size; ++j) {
-            poly_exp_t tmp = p->monos[j].exp + PolyDeg(&p->monos[j].p);
-            if (p->monos[j].exp == -1) {
-                ++tmp;
-            }
+        return PolyGetMeta(p)->deg;
+    }
+}
 
-            result = (tmp > result) ? tmp : result;
-        }
+unsigned PolyVarCount(const Poly *p) {
+    return PolyIsCoeff(p) ? 0 : PolyGetMeta(p)->vars;
+}
 
-        return result;
-    }
+size_t PolyTermCount(const Poly *p) {
+    return PolyIsCoeff(p) ? !PolyIsZero(p) : PolyGetMeta(p)->terms;
 }
 
 Poly PolyAdd(const Poly *p, const Poly *q) {
@@ -149,9 +609,8 @@ Poly PolyAdd(const Poly *p, const Poly *q) {
         return PolyFromCoeff(p->coeff + q->coeff);
     } else if (PolyIsCoeff(p)) {
         if (q->monos[0].exp >= 0) {
-            Poly result = (Poly) {.monos = malloc(sizeof(Mono) * (q->size + 1)),
-                                  .size = q->size + 1, .coeff = 0};
-            CheckAllocation(result.monos);
+            Poly result = (Poly) {.monos = PolyMalloc(sizeof(Mono) * (q->size + 1)),
+                                  .size = q->size + 1};
             result.monos[0] = (Mono) {.p = PolyClone(p), .exp = -1};
 
             for (unsigned j = 1; j <= q->size; ++j) {
@@ -163,16 +622,16 @@ Poly PolyAdd(const Poly *p, const Poly *q) {
             Poly result;
 
             if (q->monos[0].p.coeff == -p->coeff) {
-                Mono *newMonos = malloc(sizeof(Mono) * (q->size - 1));
-                CheckAllocation(newMonos);
+                Mono *newMonos = PolyMalloc(sizeof(Mono) * (q->size - 1));
 
                 for (unsigned j = 0; j < q->size - 1; ++j) {
                     newMonos[j] = MonoClone(&q->monos[j + 1]);
                 }
 
-                result = (Poly) {.monos = newMonos, .size = q->size - 1, .coeff = 0};
+                result = (Poly) {.monos = newMonos, .size = q->size - 1};
             } else {
                 result = PolyClone(q);
+                PolyMakeUnique(&result);
                 result.monos[0].p.coeff += p->coeff;
             }
 
@@ -185,33 +644,25 @@ Poly PolyAdd(const Poly *p, const Poly *q) {
         unsigned i = 0;
         unsigned j = 0;
         unsigned newSize = 0;
-        Mono *monosPlaceholder = malloc(sizeof(Mono) * (p->size + q->size));
-        CheckAllocation(monosPlaceholder);
+        Mono *monos = PolyMalloc(sizeof(Mono) * (p->size + q->size));
 
         while (i < p->size || j < q->size) {
             if (i < p->size && j < q->size) {
                 if (p->monos[i].exp < q->monos[j].exp) {
-                    monosPlaceholder[newSize] = MonoClone(&p->monos[i]);
+                    monos[newSize] = MonoClone(&p->monos[i]);
                     newSize++;
                     i++;
                 }
                 else if (p->monos[i].exp > q->monos[j].exp) {
-                    monosPlaceholder[newSize] = MonoClone(&q->monos[j]);
+                    monos[newSize] = MonoClone(&q->monos[j]);
                     newSize++;
                     j++;
                 }
                 else {
-                    Poly tmp1 = PolyClone(&p->monos[i].p);
-                    Poly tmp2 = PolyClone(&q->monos[j].p);
-                    Poly tmp3 = PolyNeg(&tmp2);
-
-                    bool newComponent = !PolyIsEq(&tmp1, &tmp3);
+                    Poly toAdd = PolyAdd(&p->monos[i].p, &q->monos[j].p);
 
-                    PolyDestroy(&tmp1), PolyDestroy(&tmp2), PolyDestroy(&tmp3);
-
-                    if (newComponent) {
-                        Poly toAdd = PolyAdd(&p->monos[i].p, &q->monos[j].p);
-                        monosPlaceholder[newSize] = MonoFromPoly(&toAdd, p->monos[i].exp);
+                    if (!PolyIsZero(&toAdd)) {
+                        monos[newSize] = MonoFromPoly(&toAdd, p->monos[i].exp);
                         newSize++;
                     }
 
@@ -219,191 +670,455 @@ Poly PolyAdd(const Poly *p, const Poly *q) {
                     j++;
                 }
             } else if (i < p->size) {
-                monosPlaceholder[newSize] = MonoClone(&p->monos[i]);
+                monos[newSize] = MonoClone(&p->monos[i]);
                 newSize++;
                 i++;
             } else {
-                monosPlaceholder[newSize] = MonoClone(&q->monos[j]);
+                monos[newSize] = MonoClone(&q->monos[j]);
                 newSize++;
                 j++;
             }
         }
 
-        Mono *properMonos;
-
-        if (newSize) {
-            properMonos = malloc(sizeof(Mono) * newSize);
-            CheckAllocation(properMonos);
-
-            for (unsigned k = 0; k < newSize; ++k) {
-                properMonos[k] = monosPlaceholder[k];
-            }
+        if (!newSize) {
+            PolyFree(monos);
 
-            if (newSize == 1 && properMonos[0].exp == -1) {
-                Poly result = properMonos[0].p;
-                free(properMonos);
-                free(monosPlaceholder);
+            return PolyZero();
+        } else if (newSize == 1 && monos[0].exp == -1) {
+            Poly result = monos[0].p;
+            PolyFree(monos);
 
-                return result;
-            }
-        } else {
-            properMonos = NULL;
+            return result;
+        } else if (newSize < p->size + q->size) {
+            monos = PolyRealloc(monos, sizeof(Mono) * newSize);
         }
 
-        free(monosPlaceholder);
-
-        return (Poly) {.monos = properMonos, .size = newSize, .coeff = 0};
+        return (Poly) {.monos = monos, .size = newSize};
     }
 }
 
 /**
- * Zwraca współczynnik @p coeff podniesiony do potęgi @p exp.
- * @param[in] coeff : współczynnik
- * @param[in] exp : wykładnik
- * @return `coeff^exp`
+ * Dodaje współczynnik @p c do wielomianu @p q niebędącego współczynnikiem.
+ * Przejmuje na własność zawartość struktury wskazywanej przez @p q i wykorzystuje
+ * ponownie jej tablicę jednomianów.
+ * @param[in] c : współczynnik
+ * @param[in,out] q : wielomian niebędący współczynnikiem
+ * @return `c + q`
  */
-static poly_coeff_t CoeffPower(poly_coeff_t coeff, poly_exp_t exp) {
-    if (exp <= 0) {
-        return 1;
+static Poly PolyAddCoeffOwned(poly_coeff_t c, Poly *q) {
+    if (!c) {
+        return *q;
     }
 
-    poly_coeff_t result = 1;
+    PolyMakeUnique(q);
 
-    while (exp) {
-        if (exp & 1) {
-            result *= coeff;
-        }
+    if (q->monos[0].exp >= 0) {
+        Mono *monos = PolyRealloc(q->monos, sizeof(Mono) * (q->size + 1));
+        memmove(monos + 1, monos, sizeof(Mono) * q->size);
+        monos[0] = (Mono) {.p = PolyFromCoeff(c), .exp = -1};
 
-        exp >>= 1;
-        coeff *= coeff;
-    }
+        return (Poly) {.monos = monos, .size = q->size + 1};
+    } else if (q->monos[0].p.coeff != -c) {
+        q->monos[0].p.coeff += c;
 
-    return result;
-}
+        return *q;
+    } else if (q->size == 1) {
+        PolyFree(q->monos);
 
-/**
- * Mnoży skalarnie wielomian @p p przez stałą @p mult.
- * @param[in,out] p : wielomian
- * @param[in] mult : skalar
- */
-static void PolyScalarMul(Poly *p, poly_coeff_t mult) {
-    if (PolyIsCoeff(p)) {
-        p->coeff *= mult;
-        return;
+        return PolyZero();
     } else {
-        unsigned newSize = 0;
-
-        for (unsigned j = 0; j < p->size; ++j) {
-            PolyScalarMul(&p->monos[j].p, mult);
-            newSize += !PolyIsZero(&p->monos[j].p);
-        }
-        
-        if (!newSize) {
-            free(p->monos);
-            p->monos = NULL;
-            p->coeff = 0;
-        } else {
-            unsigned counter = 0;
-            Mono *newMonos = malloc(sizeof(Mono) * newSize);
-            CheckAllocation(newMonos);
-
-            for (unsigned j = 0; j < p->size; ++j) {
-                if (!PolyIsZero(&p->monos[j].p)) {
-                    newMonos[counter] = p->monos[j];
-                    ++counter;
-                }
-            }
+        memmove(q->monos, q->monos + 1, sizeof(Mono) * (q->size - 1));
+        Mono *monos = PolyRealloc(q->monos, sizeof(Mono) * (q->size - 1));
 
-            free(p->monos);
-            p->monos = newMonos;
-        }
+        return (Poly) {.monos = monos, .size = q->size - 1};
     }
 }
 
-Poly PolyAt(const Poly *p, poly_coeff_t x) {
-    if (PolyIsCoeff(p)) {
-        return PolyClone(p);
+Poly PolyAddOwned(Poly *p, Poly *q) {
+    if (PolyIsZero(p)) {
+        return *q;
+    } else if (PolyIsZero(q)) {
+        return *p;
+    } else if (PolyIsCoeff(p) && PolyIsCoeff(q)) {
+        return PolyFromCoeff(p->coeff + q->coeff);
+    } else if (PolyIsCoeff(p)) {
+        return PolyAddCoeffOwned(p->coeff, q);
+    } else if (PolyIsCoeff(q)) {
+        return PolyAddCoeffOwned(q->coeff, p);
     } else {
-        Poly result = PolyFromCoeff(0);
+        if (p->size < q->size) {
+            Poly *tmp = p;
+            p = q;
+            q = tmp;
+        }
 
-        for (unsigned j = 0; j < p->size; ++j) {
-            poly_coeff_t mult = CoeffPower(x, p->monos[j].exp);
-            Poly a = PolyClone(&p->monos[j].p);
-            PolyScalarMul(&a, mult);
+        PolyMakeUnique(p);
+        PolyMakeUnique(q);
 
-            Poly tmp = PolyAdd(&result, &a);
+        // Scalamy od końca w tablicy większego wielomianu, więc pozycja zapisu
+        // nigdy nie wyprzedza pozycji odczytu.
+        Mono *monos = PolyRealloc(p->monos, sizeof(Mono) * (p->size + q->size));
 
-            PolyDestroy(&result), PolyDestroy(&a);
-            result = tmp;
-        }
+        unsigned i = p->size;
+        unsigned j = q->size;
+        unsigned w = p->size + q->size;
 
-        return result;
+        while (j > 0) {
+            if (i > 0 && monos[i - 1].exp > q->monos[j - 1].exp) {
+                monos[--w] = monos[--i];
+            } else if (i == 0 || monos[i - 1].exp < q->monos[j - 1].exp) {
+                monos[--w] = q->monos[--j];
+            } else {
+                --i, --j;
+                Poly sum = PolyAddOwned(&monos[i].p, &q->monos[j].p);
+
+                if (!PolyIsZero(&sum)) {
+                    monos[--w] = (Mono) {.p = sum, .exp = monos[i].exp};
+                }
+            }
+        }
+
+        PolyFree(q->monos);
+
+        unsigned newSize = i + (p->size + q->size - w);
+
+        if (i < w) {
+            memmove(monos + i, monos + w, sizeof(Mono) * (newSize - i));
+        }
+
+        if (!newSize) {
+            PolyFree(monos);
+
+            return PolyZero();
+        } else if (newSize == 1 && monos[0].exp == -1) {
+            Poly result = monos[0].p;
+            PolyFree(monos);
+
+            return result;
+        }
+
+        monos = PolyRealloc(monos, sizeof(Mono) * newSize);
+
+        return (Poly) {.monos = monos, .size = newSize};
     }
 }
 
+Poly PolySubOwned(Poly *p, Poly *q) {
+    PolyNegRec(q);
+
+    return PolyAddOwned(p, q);
+}
+
 /**
- * Sprawdza, czy jednomian @p a posiada większy wykładnik od wykładnika jednomianu @p b.
- * @param[in] a : jednomian
- * @param[in] b : jednomian
- * @return czy wykładnik jednomianu @p a jest większy od wykładnika jednomianu @p b?
+ * Zwraca numer kubełka akumulatora dla wielomianu @p p: najmniejsze `i`
+ * takie, że @p p ma co najwyżej @f$4^{i+1}@f$ jednomianów.
+ * @param[in] p : wielomian
+ * @return numer kubełka
  */
-static inline int MonoComparator(const void *a, const void *b) {
-    return (((Mono*)a)->exp > ((Mono*)b)->exp) ? 1 : 0;
+static unsigned AccBucket(const Poly *p) {
+    unsigned i = 0;
+
+    for (size_t cap = 4; i + 1 < POLY_ACC_BUCKETS && p->size > cap; cap *= 4) {
+        ++i;
+    }
+
+    return i;
+}
+
+void AccAdd(PolyAccumulator *acc, Poly *p) {
+    Poly sum = *p;
+    unsigned i = AccBucket(&sum);
+
+    // Scalamy z kubełkiem, dopóki suma nie mieści się w pustym kubełku.
+    while (!PolyIsZero(&acc->buckets[i])) {
+        sum = PolyAddOwned(&acc->buckets[i], &sum);
+        acc->buckets[i] = PolyZero();
+
+        unsigned j = AccBucket(&sum);
+        i = (j > i) ? j : i;
+    }
+
+    acc->buckets[i] = sum;
+
+    if (i >= acc->top) {
+        acc->top = i + 1;
+    }
+}
+
+void AccAddMonos(PolyAccumulator *acc, unsigned count, const Mono monos[]) {
+    Poly p = PolyAddMonos(count, monos);
+    AccAdd(acc, &p);
+}
+
+Poly AccFinish(PolyAccumulator *acc) {
+    Poly result = PolyZero();
+
+    for (unsigned i = 0; i < acc->top; ++i) {
+        result = PolyAddOwned(&result, &acc->buckets[i]);
+        acc->buckets[i] = PolyZero();
+    }
+
+    acc->top = 0;
+
+    return result;
 }
 
 /**
- * Sprowadza wielomian @p do postaci pożądanej przez implementację.
+ * Mnoży skalarnie wielomian @p p przez stałą @p mult. Jednomiany, które się
+ * wyzerowały, są usuwane z tablicy w miejscu, więc niewspółdzielony wielomian
+ * nie wymaga nowych alokacji.
  * @param[in,out] p : wielomian
+ * @param[in] mult : skalar
+ */
+static void PolyScalarMul(Poly *p, poly_coeff_t mult) {
+    if (PolyIsCoeff(p)) {
+        p->coeff *= mult;
+        return;
+    }
+
+    unsigned newSize = 0;
+    PolyMakeUnique(p);
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        PolyScalarMul(&p->monos[j].p, mult);
+
+        if (!PolyIsZero(&p->monos[j].p)) {
+            p->monos[newSize++] = p->monos[j];
+        }
+    }
+
+    if (!newSize) {
+        PolyFree(p->monos);
+        *p = PolyZero();
+    } else if (newSize == 1 && p->monos[0].exp == -1) {
+        Poly q = p->monos[0].p;
+        PolyFree(p->monos);
+        *p = q;
+    } else if (newSize < p->size) {
+        p->monos = PolyRealloc(p->monos, sizeof(Mono) * newSize);
+        p->size = newSize;
+    }
+}
+
+/**
+ * Sprowadza wielomian @p do postaci pożądanej przez implementację: wyraz wolny
+ * współczynnika przy `x^0` przenosi do wyrazu wolnego (wykładnik -1) całego
+ * wielomianu, a wielomian złożony z samego wyrazu wolnego zastępuje
+ * współczynnikiem. Nie alokuje pamięci poza zmianą rozmiaru tablicy.
+ * @param[in,out] p : wielomian, którego współczynniki są w tej postaci
  */
 static void NormalizePoly(Poly *p) {
-    if (!PolyIsCoeff(p)) {
-        poly_coeff_t val;
-        bool polyIsBad = false;
-
-        if (p->size == 1 && p->monos[0].exp == -1) {
-            Poly q = p->monos[0].p;
-            free(p->monos);
-            *p = q;
-        } else if (p->monos[0].exp == 0 && p->monos[0].p.monos[0].exp == -1) {
-            val = p->monos[0].p.monos[0].p.coeff;
-            polyIsBad = true;
-        } else if (p->size > 1 && p->monos[0].exp == -1 && p->monos[1].exp == 0
-                   && p->monos[1].p.monos[0].exp == -1) {
-            val = p->monos[1].p.monos[0].p.coeff;
-            polyIsBad = true;
-        }
-
-        if (polyIsBad) {
-            Poly toAdd = PolyFromCoeff(val);
-            Poly toSub = (Poly) {.monos = malloc(sizeof(Mono)), .size = 1, .coeff = 0};
-            CheckAllocation(toSub.monos);
-            Poly coeffPlaceholder = (Poly) {.monos = malloc(sizeof(Mono)), .size = 1, .coeff = 0};
-            CheckAllocation(coeffPlaceholder.monos);
-
-            Mono m2 = MonoFromPoly(&toAdd, 0);
-            Mono m1 = MonoFromPoly(&coeffPlaceholder, 0);
-            toSub.monos[0] = m1;
-            coeffPlaceholder.monos[0] = m2;
-            
-            Poly tmp = PolyAdd(p, &toAdd);
-            PolyDestroy(p);
-            *p = tmp;
-            
-            tmp = PolySub(p, &toSub);
-            PolyDestroy(p);
-            *p = tmp;
-
-            PolyDestroy(&toSub);
+    if (PolyIsCoeff(p)) {
+        return;
+    }
+
+    PolyMakeUnique(p);
+    unsigned zero = (p->monos[0].exp == -1) ? 1 : 0;
+
+    if (zero < p->size && p->monos[zero].exp == 0) {
+        Poly *c = &p->monos[zero].p;
+        poly_coeff_t val = 0;
+
+        if (PolyIsCoeff(c)) {
+            val = c->coeff;
+            memmove(p->monos + zero, p->monos + zero + 1, sizeof(Mono) * (p->size - zero - 1));
+
+            if (!--p->size) {
+                PolyFree(p->monos);
+                *p = PolyFromCoeff(val);
+                return;
+            }
+        } else if (c->monos[0].exp == -1) {
+            val = c->monos[0].p.coeff;
+            *c = PolyAddCoeffOwned(-val, c);
+        }
+
+        if (val) {
+            *p = PolyAddCoeffOwned(val, p);
+        }
+    }
+
+    if (!PolyIsCoeff(p) && p->size == 1 && p->monos[0].exp == -1) {
+        Poly q = p->monos[0].p;
+        PolyFree(p->monos);
+        *p = q;
+    }
+}
+
+/**
+ * Największa liczba jednomianów, które `MonoSort` sortuje przez wstawianie
+ * zamiast sortowania pozycyjnego.
+ */
+#ifndef MONO_SORT_INSERTION_MAX
+#define MONO_SORT_INSERTION_MAX 32
+#endif
+
+/**
+ * Liczba bitów cyfry sortowania pozycyjnego.
+ */
+#define RADIX_BITS 8
+
+/**
+ * Liczba możliwych wartości cyfry sortowania pozycyjnego.
+ */
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+/**
+ * Liczba cyfr klucza sortowania pozycyjnego.
+ */
+#define RADIX_DIGITS (32 / RADIX_BITS)
+
+/**
+ * Zwraca klucz sortowania jednomianu @p m. Wyraz wolny (wykładnik -1) ma
+ * klucz 0, a klucze pozostałych jednomianów zachowują kolejność wykładników.
+ * @param[in] m : jednomian
+ * @return klucz
+ */
+static inline uint32_t MonoSortKey(const Mono *m) {
+    return (uint32_t)m->exp + 1u;
+}
+
+/**
+ * Sortuje stabilnie przez wstawianie jednomiany z tablicy @p monos.
+ * @param[in,out] monos : tablica jednomianów
+ * @param[in] n : rozmiar tablicy @p monos
+ */
+static void MonoInsertionSort(Mono monos[], size_t n) {
+    for (size_t k = 1; k < n; ++k) {
+        Mono m = monos[k];
+        size_t j = k;
+
+        while (j > 0 && monos[j - 1].exp > m.exp) {
+            monos[j] = monos[j - 1];
+            --j;
+        }
+
+        monos[j] = m;
+    }
+}
+
+/**
+ * Sortuje stabilnie jednomiany z tablicy @p monos niemalejąco po wykładnikach,
+ * które muszą być nie mniejsze niż -1. Tablica już posortowana jest tylko
+ * sprawdzana, krótkie tablice są sortowane przez wstawianie, a dłuższe
+ * sortowaniem pozycyjnym (LSD) po bajtach wykładnika z pamięcią pomocniczą
+ * z areny, pomijając bajty równe we wszystkich wykładnikach.
+ * @param[in,out] monos : tablica jednomianów
+ * @param[in] n : rozmiar tablicy @p monos
+ */
+static void MonoSort(Mono monos[], size_t n) {
+    bool sorted = true;
+
+    for (size_t k = 1; k < n && sorted; ++k) {
+        sorted = (monos[k - 1].exp <= monos[k].exp);
+    }
+
+    if (sorted) {
+        return;
+    } else if (n <= MONO_SORT_INSERTION_MAX) {
+        MonoInsertionSort(monos, n);
+        return;
+    }
+
+    ArenaMark mark = ArenaSave();
+    size_t (*counts)[RADIX_SIZE] = ArenaAlloc(sizeof(size_t) * RADIX_SIZE * RADIX_DIGITS);
+    memset(counts, 0, sizeof(size_t) * RADIX_SIZE * RADIX_DIGITS);
+
+    // Liczności wszystkich cyfr zliczamy w jednym przebiegu.
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t key = MonoSortKey(&monos[k]);
+
+        for (unsigned d = 0; d < RADIX_DIGITS; ++d) {
+            ++counts[d][(key >> (d * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        }
+    }
+
+    Mono *src = monos;
+    Mono *dst = ArenaAlloc(sizeof(Mono) * n);
+
+    for (unsigned d = 0; d < RADIX_DIGITS; ++d) {
+        unsigned shift = d * RADIX_BITS;
+
+        // Cyfra równa we wszystkich kluczach nie zmienia kolejności.
+        if (counts[d][(MonoSortKey(&src[0]) >> shift) & (RADIX_SIZE - 1)] == n) {
+            continue;
+        }
+
+        size_t offset = 0;
+
+        for (unsigned b = 0; b < RADIX_SIZE; ++b) {
+            size_t count = counts[d][b];
+            counts[d][b] = offset;
+            offset += count;
+        }
+
+        for (size_t k = 0; k < n; ++k) {
+            dst[counts[d][(MonoSortKey(&src[k]) >> shift) & (RADIX_SIZE - 1)]++] = src[k];
+        }
+
+        Mono *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != monos) {
+        memcpy(monos, src, sizeof(Mono) * n);
+    }
+
+    ArenaRestore(mark);
+}
+
+/**
+ * Sumuje jednomiany z tablicy @p monos, przejmując na własność zarówno
+ * tablicę, jak i jej zawartość. Tablica jest sortowana w miejscu, jednomiany
+ * o równych wykładnikach są sumowane przez `PolyAddOwned`, a wynikowa tablica
+ * jest zmniejszana do liczby niezerowych jednomianów i staje się tablicą
+ * jednomianów wyniku.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów zaalokowana przez `PolyMalloc`
+ * @return wielomian będący sumą jednomianów
+ */
+static Poly PolySumMonosOwned(unsigned count, Mono *monos) {
+    MonoSort(monos, count);
+
+    unsigned newSize = 0;
+
+    for (unsigned j = 0; j < count; ++j) {
+        if (newSize && monos[newSize - 1].exp == monos[j].exp) {
+            Poly sum = PolyAddOwned(&monos[newSize - 1].p, &monos[j].p);
+
+            if (PolyIsZero(&sum)) {
+                --newSize;
+            } else {
+                monos[newSize - 1].p = sum;
+            }
+        } else if (!PolyIsZero(&monos[j].p)) {
+            monos[newSize++] = monos[j];
+        } else {
+            MonoDestroy(&monos[j]);
         }
     }
+
+    if (!newSize) {
+        PolyFree(monos);
+        return PolyFromCoeff(0);
+    }
+
+    if (newSize < count) {
+        monos = PolyRealloc(monos, sizeof(Mono) * newSize);
+    }
+
+    Poly result = (Poly) {.monos = monos, .size = newSize};
+    NormalizePoly(&result);
+
+    return result;
 }
 
 Poly PolyAddMonos(unsigned count, const Mono monos[]) {
     if (!count) {
         return PolyFromCoeff(0);
     } else {
-        Mono *monosCopy = malloc(sizeof(Mono) * count);
-        CheckAllocation(monosCopy);
+        Mono *monosCopy = PolyMalloc(sizeof(Mono) * count);
 
         for (unsigned j = 0; j < count; ++j) {
             monosCopy[j] = monos[j];
@@ -412,176 +1127,965 @@ Poly PolyAddMonos(unsigned count, const Mono monos[]) {
                 monosCopy[j].exp = -1;
             }
         }
-        
-        qsort(monosCopy, count, sizeof(Mono), MonoComparator);
 
-        poly_exp_t lastExp = -2;
-        unsigned newSize = 0;
-        Poly summand = PolyFromCoeff(0);
-        
-        Mono *monosPlaceholder = malloc(sizeof(Mono) * count);
-        CheckAllocation(monosPlaceholder);
+        return PolySumMonosOwned(count, monosCopy);
+    }
+}
 
-        for (unsigned j = 0; j < count; ++j) {
-            if (lastExp != monosCopy[j].exp) {
-                if (!PolyIsZero(&summand)) {
-                    monosPlaceholder[newSize] = (Mono) {.p = summand, .exp = lastExp};
-                    newSize++;
-                }
+Poly PolyAddMonosOwned(unsigned count, Mono *monos) {
+    if (!count) {
+        PolyFree(monos);
+        return PolyFromCoeff(0);
+    }
 
-                summand = PolyClone(&monosCopy[j].p);
-                lastExp = monosCopy[j].exp;
-            } else {
-                Poly tmp = PolyAdd(&summand, &monosCopy[j].p);
-                PolyDestroy(&summand);
-                summand = tmp;
-            }
+    for (unsigned j = 0; j < count; ++j) {
+        if (monos[j].exp == 0 && PolyIsCoeff(&monos[j].p)) {
+            monos[j].exp = -1;
         }
+    }
 
-        if (!PolyIsZero(&summand)) {
-            monosPlaceholder[newSize] = (Mono) {.p = summand, .exp = lastExp};
-            newSize++;
+    return PolySumMonosOwned(count, monos);
+}
+
+#if !defined(NDEBUG) || defined(UNIT_TESTING)
+/**
+ * Sprawdza, czy jednomiany z tablicy @p monos mają ściśle rosnące wykładniki
+ * i niezerowe współczynniki, a stała przy `x^0` ma wykładnik -1.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return czy tablicę można przekazać do `PolyFromSortedMonosOwned`?
+ */
+static bool MonosAreSorted(unsigned count, const Mono monos[]) {
+    for (unsigned j = 0; j < count; ++j) {
+        if (PolyIsZero(&monos[j].p) || (j && monos[j - 1].exp >= monos[j].exp)
+            || (monos[j].exp == 0 && PolyIsCoeff(&monos[j].p))) {
+            return false;
         }
+    }
 
-        Poly result;
+    return true;
+}
+#endif
 
-        if (!newSize) {
-            result = PolyFromCoeff(0);
+Poly PolyFromSortedMonosOwned(unsigned count, Mono *monos) {
+    assert(MonosAreSorted(count, monos));
+
+    if (!count) {
+        PolyFree(monos);
+        return PolyFromCoeff(0);
+    }
+
+    // Tablica pochodząca z wektora może być większa niż potrzeba; zmniejszenie
+    // bloku zapełnionego co najmniej w połowie zostawia go na miejscu.
+    monos = PolyRealloc(monos, sizeof(Mono) * count);
+
+    Poly result = (Poly) {.monos = monos, .size = count};
+    NormalizePoly(&result);
+
+    return result;
+}
+
+Poly PolyAt(const Poly *p, poly_coeff_t x) {
+    if (PolyIsCoeff(p)) {
+        return PolyClone(p);
+    }
+
+    unsigned total = 0;
+    bool allCoeffs = true;
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        const Poly *c = &p->monos[j].p;
+        total += PolyIsCoeff(c) ? 1 : c->size;
+        allCoeffs &= PolyIsCoeff(c);
+    }
+
+    // Wszystkie współczynniki są stałymi - wynik liczymy bez alokacji.
+    PowerWalk walk = PowerWalkStart(x);
+
+    if (allCoeffs) {
+        poly_coeff_t result = 0;
+
+        for (unsigned j = 0; j < p->size && PowerWalkLive(&walk); ++j) {
+            result += p->monos[j].p.coeff * PowerWalkNext(&walk, p->monos[j].exp);
+        }
+
+        return PolyFromCoeff(result);
+    }
+
+    // Jednomiany przeskalowanych współczynników zbieramy w jednej tablicy
+    // i sumujemy je na końcu w jednym przebiegu.
+    Mono *monos = PolyMalloc(sizeof(Mono) * total);
+    unsigned count = 0;
+
+    for (unsigned j = 0; j < p->size && PowerWalkLive(&walk); ++j) {
+        poly_coeff_t power = PowerWalkNext(&walk, p->monos[j].exp);
+        const Poly *c = &p->monos[j].p;
+
+        if (PolyIsCoeff(c)) {
+            monos[count++] = (Mono) {.p = PolyFromCoeff(c->coeff * power), .exp = -1};
         } else {
-            Mono *properMonos = malloc(sizeof(Mono) * newSize);
-            CheckAllocation(properMonos);
+            for (unsigned k = 0; k < c->size; ++k) {
+                Poly scaled = PolyCloneScaled(&c->monos[k].p, power);
+                monos[count++] = MonoFromPoly(&scaled, c->monos[k].exp);
+            }
+        }
+    }
+
+    if (!count) {
+        PolyFree(monos);
+        return PolyFromCoeff(0);
+    }
+
+    return PolySumMonosOwned(count, monos);
+}
+
+/**
+ * Wylicza wartość wielomianu @p p zmiennych `x_idx, x_{idx + 1}, ...` po
+ * podstawieniu `vals[j]` pod `x_j` dla `j < n` i zera pod pozostałe zmienne.
+ * @param[in] p : wielomian
+ * @param[in] idx : indeks zmiennej głównej @p p
+ * @param[in] n : rozmiar tablicy @p vals
+ * @param[in] vals : tablica wartości zmiennych
+ * @return wartość wielomianu
+ */
+static poly_coeff_t PolyEvalRec(const Poly *p, unsigned idx, unsigned n,
+                                const poly_coeff_t vals[]) {
+    if (PolyIsCoeff(p)) {
+        return p->coeff;
+    }
+
+    PowerWalk walk = PowerWalkStart((idx < n) ? vals[idx] : 0);
+    poly_coeff_t result = 0;
+
+    for (unsigned j = 0; j < p->size && PowerWalkLive(&walk); ++j) {
+        poly_coeff_t power = PowerWalkNext(&walk, p->monos[j].exp);
+
+        if (power) {
+            result += PolyEvalRec(&p->monos[j].p, idx + 1, n, vals) * power;
+        }
+    }
+
+    return result;
+}
+
+poly_coeff_t PolyEvalAll(const Poly *p, unsigned n, const poly_coeff_t vals[]) {
+    return PolyEvalRec(p, 0, n, vals);
+}
+
+/**
+ * Zwraca wykładnik iloczynu jednomianów o wykładnikach @p a i @p b
+ * z uwzględnieniem wykładnika `-1` oznaczającego wyraz wolny.
+ * Dla ustalonego jednego z argumentów wynik jest niemalejący względem drugiego.
+ * @param[in] a : wykładnik
+ * @param[in] b : wykładnik
+ * @return wykładnik iloczynu
+ */
+static inline poly_exp_t MonoMulExp(poly_exp_t a, poly_exp_t b) {
+    if (a == -1 && b == -1) {
+        return -1;
+    } else if (a == -1 || b == -1) {
+        return a + b + 1;
+    } else {
+        return a + b;
+    }
+}
+
+/**
+ * Element kopca używanego przy mnożeniu wielomianów.
+ * Reprezentuje iloczyn jednomianu `i` mniejszego czynnika i jednomianu `j`
+ * większego czynnika.
+ */
+typedef struct MulHeapEntry {
+    poly_exp_t exp; ///< wykładnik iloczynu
+    unsigned i; ///< indeks jednomianu w mniejszym czynniku
+    unsigned j; ///< indeks jednomianu w większym czynniku
+} MulHeapEntry;
+
+/**
+ * Wstawia element @p e do kopca minimalnego (względem wykładnika) @p heap
+ * o rozmiarze @p size.
+ * @param[in,out] heap : kopiec
+ * @param[in,out] size : rozmiar kopca
+ * @param[in] e : wstawiany element
+ */
+static void MulHeapPush(MulHeapEntry heap[], unsigned *size, MulHeapEntry e) {
+    unsigned pos = (*size)++;
+
+    while (pos > 0 && heap[(pos - 1) / 2].exp > e.exp) {
+        heap[pos] = heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+
+    heap[pos] = e;
+}
+
+/**
+ * Usuwa i zwraca element o najmniejszym wykładniku z kopca @p heap
+ * o rozmiarze @p size.
+ * @param[in,out] heap : niepusty kopiec
+ * @param[in,out] size : rozmiar kopca
+ * @return element o najmniejszym wykładniku
+ */
+static MulHeapEntry MulHeapPop(MulHeapEntry heap[], unsigned *size) {
+    MulHeapEntry top = heap[0];
+    MulHeapEntry last = heap[--(*size)];
+    unsigned pos = 0;
+
+    while (2 * pos + 1 < *size) {
+        unsigned child = 2 * pos + 1;
+
+        if (child + 1 < *size && heap[child + 1].exp < heap[child].exp) {
+            ++child;
+        }
+
+        if (heap[child].exp >= last.exp) {
+            break;
+        }
+
+        heap[pos] = heap[child];
+        pos = child;
+    }
+
+    if (*size) {
+        heap[pos] = last;
+    }
+
+    return top;
+}
+
+/**
+ * Mnoży dwa wielomiany, które nie są współczynnikami.
+ * Iloczyny par jednomianów generowane są w kolejności niemalejących wykładników
+ * za pomocą kopca o rozmiarze co najwyżej `min(p->size, q->size)`, a iloczyny
+ * o równych wykładnikach są od razu sumowane, więc pamięć pomocnicza jest
+ * liniowa względem rozmiaru wyniku i mniejszego czynnika.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @param[in] q : wielomian niebędący współczynnikiem
+ * @return `p * q`
+ */
+static Poly PolyMulHeap(const Poly *p, const Poly *q) {
+    if (p->size > q->size) {
+        const Poly *tmp = p;
+        p = q;
+        q = tmp;
+    }
+
+    ArenaMark mark = ArenaSave();
+    unsigned heapSize = 0;
+    MulHeapEntry *heap = ArenaAlloc(sizeof(MulHeapEntry) * p->size);
+
+    unsigned newSize = 0;
+    unsigned maxSize = p->size + q->size;
+    Mono *monos = PolyMalloc(sizeof(Mono) * maxSize);
+
+    MulHeapPush(heap, &heapSize, (MulHeapEntry) {
+            .exp = MonoMulExp(p->monos[0].exp, q->monos[0].exp), .i = 0, .j = 0});
+
+    // Iloczyny o tym samym wykładniku sumujemy w akumulatorze, który
+    // AccFinish opróżnia dla kolejnego wykładnika.
+    PolyAccumulator summand = AccCreate();
+
+    while (heapSize) {
+        poly_exp_t exp = heap[0].exp;
 
-            for (unsigned j = 0; j < newSize; ++j) {
-                properMonos[j] = monosPlaceholder[j];
+        while (heapSize && heap[0].exp == exp) {
+            MulHeapEntry e = MulHeapPop(heap, &heapSize);
+
+            Poly prod = PolyMul(&p->monos[e.i].p, &q->monos[e.j].p);
+            AccAdd(&summand, &prod);
+
+            if (e.j == 0 && e.i + 1 < p->size) {
+                MulHeapPush(heap, &heapSize, (MulHeapEntry) {
+                        .exp = MonoMulExp(p->monos[e.i + 1].exp, q->monos[0].exp),
+                        .i = e.i + 1, .j = 0});
             }
 
-            result = (Poly) {.monos = properMonos, .size = newSize, .coeff = 0};
+            if (e.j + 1 < q->size) {
+                MulHeapPush(heap, &heapSize, (MulHeapEntry) {
+                        .exp = MonoMulExp(p->monos[e.i].exp, q->monos[e.j + 1].exp),
+                        .i = e.i, .j = e.j + 1});
+            }
         }
 
-        for (unsigned j = 0; j < count; ++j) {
-            MonoDestroy(&monosCopy[j]);
-        }
-        
-        free(monosCopy);
-        free(monosPlaceholder);
-        
-        NormalizePoly(&result);
-        
+        Poly sum = AccFinish(&summand);
+
+        if (!PolyIsZero(&sum)) {
+            if (newSize == maxSize) {
+                maxSize *= 2;
+                monos = PolyRealloc(monos, sizeof(Mono) * maxSize);
+            }
+
+            monos[newSize] = (Mono) {.p = sum, .exp = exp};
+            newSize++;
+        }
+    }
+
+    ArenaRestore(mark);
+
+    if (!newSize) {
+        PolyFree(monos);
+        return PolyZero();
+    }
+
+    Mono *properMonos = PolyRealloc(monos, sizeof(Mono) * newSize);
+
+    Poly result = (Poly) {.monos = properMonos, .size = newSize};
+    NormalizePoly(&result);
+
+    return result;
+}
+
+/**
+ * Sprawdza, czy wielomian @p p opłaca się mnożyć w reprezentacji gęstej,
+ * tzn. czy jest wielomianem jednej zmiennej o stałych współczynnikach, ma
+ * co najmniej `DENSE_MUL_MIN_SIZE` jednomianów i gęstość co najmniej
+ * `DENSE_MUL_MIN_DENSITY_PERCENT` procent.
+ * @param[in] p : wielomian
+ * @return czy wielomian @p p nadaje się do mnożenia w reprezentacji gęstej?
+ */
+static bool PolyIsDense(const Poly *p) {
+    if (PolyIsCoeff(p) || p->size < DENSE_MUL_MIN_SIZE) {
+        return false;
+    }
+
+    size_t length = (size_t)p->monos[p->size - 1].exp + 1;
+
+    if ((size_t)p->size * 100 < length * DENSE_MUL_MIN_DENSITY_PERCENT) {
+        return false;
+    }
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        if (!PolyIsCoeff(&p->monos[j].p)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Zapisuje wielomian jednej zmiennej @p p o stałych współczynnikach
+ * w reprezentacji gęstej. Tablica jest alokowana z areny.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @param[out] length : rozmiar zwróconej tablicy
+ * @return tablica współczynników, gdzie współczynnik przy `x^i` jest na
+ * pozycji `i`
+ */
+static poly_coeff_t *PolyToDense(const Poly *p, size_t *length) {
+    *length = (size_t)p->monos[p->size - 1].exp + 1;
+    poly_coeff_t *coeffs = ArenaAlloc(sizeof(poly_coeff_t) * *length);
+    memset(coeffs, 0, sizeof(poly_coeff_t) * *length);
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        size_t exp = (p->monos[j].exp == -1) ? 0 : (size_t)p->monos[j].exp;
+        coeffs[exp] = p->monos[j].p.coeff;
+    }
+
+    return coeffs;
+}
+
+/**
+ * Tworzy wielomian jednej zmiennej z reprezentacji gęstej.
+ * @param[in] coeffs : tablica współczynników
+ * @param[in] length : rozmiar tablicy @p coeffs
+ * @return wielomian
+ */
+static Poly PolyFromDense(const poly_coeff_t coeffs[], size_t length) {
+    unsigned newSize = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        newSize += (coeffs[i] != 0);
+    }
+
+    if (!newSize) {
+        return PolyZero();
+    } else if (newSize == 1 && coeffs[0]) {
+        return PolyFromCoeff(coeffs[0]);
+    }
+
+    Mono *monos = PolyMalloc(sizeof(Mono) * newSize);
+    unsigned counter = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        if (coeffs[i]) {
+            Poly c = PolyFromCoeff(coeffs[i]);
+            monos[counter] = MonoFromPoly(&c, (poly_exp_t)i);
+            ++counter;
+        }
+    }
+
+    return (Poly) {.monos = monos, .size = newSize};
+}
+
+/**
+ * Mnoży dwa wielomiany jednej zmiennej o stałych współczynnikach
+ * w reprezentacji gęstej algorytmem Karacuby lub Toom-3.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @param[in] q : wielomian niebędący współczynnikiem
+ * @return `p * q`
+ */
+static Poly PolyMulDense(const Poly *p, const Poly *q) {
+    ArenaMark mark = ArenaSave();
+    size_t n, m;
+    poly_coeff_t *a = PolyToDense(p, &n);
+    poly_coeff_t *b = PolyToDense(q, &m);
+    poly_coeff_t *res = ArenaAlloc(sizeof(poly_coeff_t) * (n + m - 1));
+
+    DenseMul(a, n, b, m, res);
+    Poly result = PolyFromDense(res, n + m - 1);
+
+    ArenaRestore(mark);
+
+    return result;
+}
+
+/**
+ * Zwraca liczbę zmiennych, od których formalnie zależy wielomian @p p, czyli
+ * głębokość drzewa jego współczynników.
+ * @param[in] p : wielomian
+ * @return głębokość wielomianu
+ */
+static unsigned PolyDepth(const Poly *p) {
+    unsigned result = 0;
+
+    if (!PolyIsCoeff(p)) {
+        for (unsigned j = 0; j < p->size; ++j) {
+            unsigned tmp = PolyDepth(&p->monos[j].p) + 1;
+            result = (tmp > result) ? tmp : result;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Zwraca liczbę niezerowych współczynników liczbowych wielomianu @p p
+ * (liści drzewa współczynników).
+ * @param[in] p : wielomian
+ * @return liczba współczynników liczbowych
+ */
+static size_t PolyLeafCount(const Poly *p) {
+    if (PolyIsCoeff(p)) {
+        return !PolyIsZero(p);
+    }
+
+    size_t result = 0;
+
+    for (unsigned j = 0; j < p->size; ++j) {
+        result += PolyLeafCount(&p->monos[j].p);
+    }
+
+    return result;
+}
+
+/**
+ * Wpisuje wielomian @p p do tablicy @p coeffs przez podstawienie Kroneckera
+ * @f$x_i = y^{s_i}@f$, gdzie @f$s_0 = 1@f$ i @f$s_{i+1} = s_i \cdot B_i@f$.
+ * @param[in] p : wielomian
+ * @param[in] bases : tablica baz @f$B_i@f$ kolejnych zmiennych
+ * @param[in] offset : pozycja w tablicy odpowiadająca dotychczasowym wykładnikom
+ * @param[in] stride : @f$s_i@f$ dla obecnej zmiennej
+ * @param[in,out] coeffs : tablica współczynników
+ */
+static void KroneckerPack(const Poly *p, const size_t bases[], size_t offset,
+                          size_t stride, poly_coeff_t coeffs[]) {
+    if (PolyIsCoeff(p)) {
+        coeffs[offset] += p->coeff;
+    } else {
+        for (unsigned j = 0; j < p->size; ++j) {
+            size_t exp = (p->monos[j].exp == -1) ? 0 : (size_t)p->monos[j].exp;
+            KroneckerPack(&p->monos[j].p, bases + 1, offset + exp * stride,
+                          stride * bases[0], coeffs);
+        }
+    }
+}
+
+/**
+ * Odtwarza wielomian ze zmiennych @f$x_0, \ldots, x_{vars-1}@f$ z tablicy
+ * @p coeffs wypełnionej przez podstawienie Kroneckera (zob. `KroneckerPack`).
+ * @param[in] coeffs : tablica współczynników
+ * @param[in] bases : tablica baz kolejnych zmiennych
+ * @param[in] vars : liczba zmiennych
+ * @param[in] offset : pozycja w tablicy odpowiadająca dotychczasowym wykładnikom
+ * @param[in] stride : krok w tablicy odpowiadający obecnej zmiennej
+ * @return wielomian
+ */
+static Poly KroneckerUnpack(const poly_coeff_t coeffs[], const size_t bases[],
+                            unsigned vars, size_t offset, size_t stride) {
+    if (!vars) {
+        return PolyFromCoeff(coeffs[offset]);
+    }
+
+    // Jedno dodatkowe miejsce na wyraz wolny wyciągnięty ze współczynnika
+    // przy x^0.
+    Mono *monos = PolyMalloc(sizeof(Mono) * (bases[0] + 1));
+    unsigned newSize = 0;
+
+    for (size_t e = 0; e < bases[0]; ++e) {
+        Poly c = KroneckerUnpack(coeffs, bases + 1, vars - 1, offset + e * stride,
+                                 stride * bases[0]);
+
+        if (PolyIsZero(&c)) {
+            continue;
+        } else if (e == 0 && !PolyIsCoeff(&c) && c.monos[0].exp == -1) {
+            monos[newSize++] = c.monos[0];
+            memmove(c.monos, c.monos + 1, sizeof(Mono) * (c.size - 1));
+            c.size--;
+        }
+
+        monos[newSize++] = MonoFromPoly(&c, (poly_exp_t)e);
+    }
+
+    if (!newSize) {
+        PolyFree(monos);
+
+        return PolyZero();
+    } else if (newSize == 1 && monos[0].exp == -1) {
+        Poly result = monos[0].p;
+        PolyFree(monos);
+
         return result;
     }
+
+    monos = PolyRealloc(monos, sizeof(Mono) * newSize);
+
+    return (Poly) {.monos = monos, .size = newSize};
+}
+
+/**
+ * Próbuje pomnożyć wielomiany wielu zmiennych @p p i @p q przez podstawienie
+ * Kroneckera: oba czynniki są zamieniane na gęste wielomiany jednej zmiennej,
+ * mnożone funkcją `DenseMul` i rozpakowywane z powrotem.
+ * Podstawienia nie wykonujemy, gdy czynniki są zbyt rzadkie lub tablica
+ * byłaby większa niż `KRONECKER_MAX_LENGTH`.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @param[in] q : wielomian niebędący współczynnikiem
+ * @param[out] result : iloczyn `p * q`, jeśli podstawienie zostało wykonane
+ * @return czy podstawienie zostało wykonane?
+ */
+static bool PolyMulKronecker(const Poly *p, const Poly *q, Poly *result) {
+    unsigned vars = PolyDepth(p);
+    unsigned qVars = PolyDepth(q);
+    vars = (qVars > vars) ? qVars : vars;
+
+    if (vars < 2) {
+        return false;
+    }
+
+    size_t pLeaves = PolyLeafCount(p);
+    size_t qLeaves = PolyLeafCount(q);
+
+    if (pLeaves < DENSE_MUL_MIN_SIZE || qLeaves < DENSE_MUL_MIN_SIZE) {
+        return false;
+    }
+
+    ArenaMark mark = ArenaSave();
+    size_t *bases = ArenaAlloc(sizeof(size_t) * vars);
+    size_t length = 1, pBox = 1, qBox = 1;
+    bool feasible = true;
+
+    for (unsigned i = 0; i < vars && feasible; ++i) {
+        size_t pDeg = (size_t)PolyDegBy(p, i) + 1;
+        size_t qDeg = (size_t)PolyDegBy(q, i) + 1;
+        bases[i] = pDeg + qDeg - 1;
+        pBox *= pDeg;
+        qBox *= qDeg;
+        feasible = (length <= KRONECKER_MAX_LENGTH / bases[i]);
+        length *= bases[i];
+    }
+
+    feasible = feasible && pLeaves * 100 >= pBox * KRONECKER_MIN_DENSITY_PERCENT
+               && qLeaves * 100 >= qBox * KRONECKER_MIN_DENSITY_PERCENT;
+
+    if (!feasible) {
+        ArenaRestore(mark);
+
+        return false;
+    }
+
+    poly_coeff_t *a = ArenaAlloc(sizeof(poly_coeff_t) * length);
+    poly_coeff_t *b = ArenaAlloc(sizeof(poly_coeff_t) * length);
+    poly_coeff_t *res = ArenaAlloc(sizeof(poly_coeff_t) * length);
+    memset(a, 0, sizeof(poly_coeff_t) * length);
+    memset(b, 0, sizeof(poly_coeff_t) * length);
+    memset(res, 0, sizeof(poly_coeff_t) * length);
+
+    KroneckerPack(p, bases, 0, 1, a);
+    KroneckerPack(q, bases, 0, 1, b);
+
+    size_t n = length, m = length;
+
+    while (n > 1 && !a[n - 1]) {
+        --n;
+    }
+
+    while (m > 1 && !b[m - 1]) {
+        --m;
+    }
+
+    DenseMul(a, n, b, m, res);
+    *result = KroneckerUnpack(res, bases, vars, 0, 1);
+
+    ArenaRestore(mark);
+
+    return true;
 }
 
 Poly PolyMul(const Poly *p, const Poly *q) {
     if (PolyIsCoeff(p) && PolyIsCoeff(q)) {
         return PolyFromCoeff(p->coeff * q->coeff);
     } else if (PolyIsCoeff(p)) {
-        Poly result = PolyClone(q);
-        PolyScalarMul(&result, p->coeff);
-
-        return result;
+        return PolyCloneScaled(q, p->coeff);
     } else if (PolyIsCoeff(q)) {
         return PolyMul(q, p);
+    } else if (PolyIsDense(p) && PolyIsDense(q)) {
+        return PolyMulDense(p, q);
     } else {
-        Mono *monos = malloc(sizeof(Mono) * p->size * q->size);
-        CheckAllocation(monos);
+        Poly result;
 
-        for (unsigned i = 0; i < p->size; ++i) {
-            for (unsigned j = 0; j < q->size; ++j) {
-                Poly tmp = PolyMul(&p->monos[i].p, &q->monos[j].p);
-                monos[i * q->size + j] = MonoFromPoly(&tmp, p->monos[i].exp
-                                                            + q->monos[j].exp);
-
-                if (p->monos[i].exp == -1 || q->monos[j].exp == -1) {
-                    monos[i * q->size + j].exp++;
-                    if (p->monos[i].exp == 1 || q->monos[j].exp == 1) {
-                        monos[i * q->size + j].exp = 1;
-                    }
-                }
-            }
+        if (!PolyMulKronecker(p, q, &result)) {
+            result = PolyMulHeap(p, q);
         }
 
-        Poly result = PolyAddMonos(p->size * q->size, monos);
-        free(monos);
+        return result;
+    }
+}
+
+Poly PolyMulOwned(Poly *p, Poly *q) {
+    if (PolyIsCoeff(p) && PolyIsCoeff(q)) {
+        return PolyFromCoeff(p->coeff * q->coeff);
+    } else if (PolyIsCoeff(p)) {
+        PolyScalarMul(q, p->coeff);
+
+        return *q;
+    } else if (PolyIsCoeff(q)) {
+        return PolyMulOwned(q, p);
+    } else {
+        Poly result = PolyMul(p, q);
+        PolyDestroy(p);
+        PolyDestroy(q);
 
         return result;
     }
 }
 
 /**
- * Zwraca wielomian @p p podniesiony do potęgi @p exp.
- * @param[in] p : wielomian
- * @param[in] exp : wykładnik
- * @return `p^{exp}`
+ * Pamięć podręczna potęg jednej z podstawianych zmiennych.
+ * Trzyma potęgi posortowane rosnąco po wykładniku.
+ */
+typedef struct PowerCache {
+    poly_exp_t *exps; ///< wykładniki potęg
+    Poly *powers; ///< potęgi
+    unsigned size; ///< liczba potęg
+    unsigned maxSize; ///< rozmiar tablic exps i powers
+} PowerCache;
+
+/**
+ * Zwraca wielomian @p x podniesiony do potęgi @p exp, korzystając z pamięci
+ * podręcznej @p cache i uzupełniając ją.
+ * Kolejne potęgi liczymy podnosząc do kwadratu potęgę o wykładniku `exp / 2`,
+ * więc ona też trafia do pamięci podręcznej.
+ * Zwrócony wskaźnik jest ważny do następnego wywołania funkcji z tą samą
+ * pamięcią podręczną.
+ * @param[in,out] cache : pamięć podręczna potęg @p x
+ * @param[in] x : wielomian
+ * @param[in] exp : wykładnik, dodatni
+ * @return `x^exp`
  */
-Poly PolyPow(const Poly *p, unsigned exp) {
-    Poly result = PolyFromCoeff(1);
-    Poly coeff = PolyClone(p);
+static const Poly *PowerCacheGet(PowerCache *cache, const Poly *x, poly_exp_t exp) {
+    if (exp == 1) {
+        return x;
+    }
+
+    unsigned lo = 0, hi = cache->size;
 
-    while (exp) {
-        if (exp & 1) {
-            Poly tmp = PolyMul(&result, &coeff);
-            PolyDestroy(&result);
-            result = tmp;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+
+        if (cache->exps[mid] < exp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
+    }
+
+    if (lo < cache->size && cache->exps[lo] == exp) {
+        return &cache->powers[lo];
+    }
+
+    const Poly *half = PowerCacheGet(cache, x, exp / 2);
+    Poly power = PolyMul(half, half);
+
+    if (exp & 1) {
+        Poly tmp = PolyMul(&power, x);
+        PolyDestroy(&power);
+        power = tmp;
+    }
+
+    // Rekurencja mogła dopisać mniejsze wykładniki, więc szukamy miejsca ponownie.
+    lo = 0;
+
+    while (lo < cache->size && cache->exps[lo] < exp) {
+        ++lo;
+    }
+
+    if (cache->size == cache->maxSize) {
+        cache->maxSize = cache->maxSize ? 2 * cache->maxSize : 8;
+        cache->exps = PolyRealloc(cache->exps, sizeof(poly_exp_t) * cache->maxSize);
+        cache->powers = PolyRealloc(cache->powers, sizeof(Poly) * cache->maxSize);
+    }
+
+    memmove(cache->exps + lo + 1, cache->exps + lo, sizeof(poly_exp_t) * (cache->size - lo));
+    memmove(cache->powers + lo + 1, cache->powers + lo, sizeof(Poly) * (cache->size - lo));
+    cache->exps[lo] = exp;
+    cache->powers[lo] = power;
+    ++cache->size;
+
+    return &cache->powers[lo];
+}
 
-        exp >>= 1;
-        Poly tmp = PolyMul(&coeff, &coeff);
-        PolyDestroy(&coeff);
-        coeff = tmp;
+/**
+ * Mnoży wielomian @p acc przez `x^exp` wzięte z pamięci podręcznej.
+ * Przejmuje na własność wielomian @p acc.
+ * @param[in] acc : wielomian
+ * @param[in,out] cache : pamięć podręczna potęg @p x
+ * @param[in] x : wielomian
+ * @param[in] exp : wykładnik
+ * @return `acc * x^exp`
+ */
+static Poly PolyMulCachedPower(Poly acc, PowerCache *cache, const Poly *x, poly_exp_t exp) {
+    if (exp <= 0 || PolyIsZero(&acc)) {
+        return acc;
     }
 
-    PolyDestroy(&coeff);
+    Poly result = PolyMul(&acc, PowerCacheGet(cache, x, exp));
+    PolyDestroy(&acc);
 
     return result;
 }
 
 /**
  * Podstawia wielomiany `x[start], ..., x[stop - 1]` pod zmienne wielomianu @p p.
+ * Na każdym poziomie liczy schematem Hornera od najwyższego wykładnika,
+ * mnożąc akumulator przez potęgi `x[start]` o wykładnikach równych różnicom
+ * kolejnych wykładników, wziętych z pamięci podręcznej @p caches.
  * @param[in] p : wielomian
  * @param[in] start : początkowy indeks @p x
  * @param[in] stop : końcowy indeks @p x
  * @param[in] x : tablica wielomianów
+ * @param[in,out] caches : pamięci podręczne potęg `x[0], ..., x[stop - 1]`
  * @return `p(x[start], x[start + 1], ..., x[stop - 1], 0, 0, ...)`
  */
-Poly PolyComposeRec(const Poly *p, unsigned start, unsigned stop, const Poly x[]) {
+static Poly PolyComposeRec(const Poly *p, unsigned start, unsigned stop, const Poly x[],
+                           PowerCache caches[]) {
     if (start == stop) {
         return PolyAt(p, 0);
     } else if (PolyIsCoeff(p)) {
         return *p;
-    } else {
-        unsigned exp = (p->monos[0].exp == -1) ? 0 : (unsigned)p->monos[0].exp;
-        Poly factor = PolyPow(&x[start], exp);
-        Poly rec = PolyComposeRec(&p->monos[0].p, start + 1, stop, x);
+    }
+
+    unsigned j = p->size - 1;
+    Poly acc = PolyComposeRec(&p->monos[j].p, start + 1, stop, x, caches);
+
+    while (j > 0) {
+        --j;
+        poly_exp_t exp = (p->monos[j].exp < 0) ? 0 : p->monos[j].exp;
+        acc = PolyMulCachedPower(acc, &caches[start], &x[start], p->monos[j + 1].exp - exp);
+
+        Poly rec = PolyComposeRec(&p->monos[j].p, start + 1, stop, x, caches);
+        acc = PolyAddOwned(&acc, &rec);
+    }
+
+    return PolyMulCachedPower(acc, &caches[start], &x[start], p->monos[0].exp);
+}
+
+Poly PolyCompose(const Poly *p, unsigned count, const Poly x[]) {
+    bool allCoeffs = true;
+
+    for (unsigned j = 0; j < count && allCoeffs; ++j) {
+        allCoeffs = PolyIsCoeff(&x[j]);
+    }
+
+    // Gdy pod wszystkie zmienne podstawiamy stałe, wynik jest liczbą.
+    if (count && allCoeffs && PolyDepth(p) <= count) {
+        ArenaMark mark = ArenaSave();
+        poly_coeff_t *vals = ArenaAlloc(sizeof(poly_coeff_t) * count);
 
-        Poly res = PolyMul(&factor, &rec);
+        for (unsigned j = 0; j < count; ++j) {
+            vals[j] = x[j].coeff;
+        }
 
-        PolyDestroy(&rec);
+        poly_coeff_t result = PolyEvalAll(p, count, vals);
+        ArenaRestore(mark);
+
+        return PolyFromCoeff(result);
+    }
 
-        for (size_t j = 1; j < p->size; ++j) {
-            Poly toMul = PolyPow(&x[start], p->monos[j].exp - exp);
-            Poly tmp = PolyMul(&factor, &toMul);
-            PolyDestroy(&factor);
-            PolyDestroy(&toMul);
-            factor = tmp;
+    ArenaMark mark = ArenaSave();
+    PowerCache *caches = ArenaAlloc(sizeof(PowerCache) * count);
 
-            rec = PolyComposeRec(&p->monos[j].p, start + 1, stop, x);
-            tmp = PolyMul(&factor, &rec);
-            PolyDestroy(&rec);
-            rec = tmp;
+    for (unsigned j = 0; j < count; ++j) {
+        caches[j] = (PowerCache) {.exps = NULL, .powers = NULL, .size = 0, .maxSize = 0};
+    }
 
-            tmp = PolyAdd(&res, &rec);
-            PolyDestroy(&res);
-            PolyDestroy(&rec);
-            res = tmp;
+    Poly result = PolyComposeRec(p, 0, count, x, caches);
 
-            exp = (unsigned)p->monos[j].exp;
+    for (unsigned j = 0; j < count; ++j) {
+        for (unsigned k = 0; k < caches[j].size; ++k) {
+            PolyDestroy(&caches[j].powers[k]);
         }
 
-        PolyDestroy(&factor);
-        return res;
+        PolyFree(caches[j].exps);
+        PolyFree(caches[j].powers);
     }
+
+    ArenaRestore(mark);
+
+    return result;
 }
 
-Poly PolyCompose(const Poly *p, unsigned count, const Poly x[]) {
-    return PolyComposeRec(p, 0, count, x);
-}
\ No newline at end of file
+/**
+ * Fragment pracy `PolyAtMany` wykonywany przez jeden wątek.
+ */
+typedef struct AtManyTask {
+    const Poly *p; ///< wielomian
+    const poly_coeff_t *dense; ///< współczynniki @p p w postaci gęstej albo NULL
+    size_t length; ///< rozmiar tablicy dense
+    const FrozenPoly *frozen; ///< zamrożony @p p albo NULL
+    const poly_coeff_t *x; ///< punkty
+    unsigned count; ///< liczba punktów
+    poly_coeff_t *values; ///< wartości w punktach, gdy dense jest różne od NULL
+    Poly *out; ///< wyniki, gdy dense jest równe NULL
+} AtManyTask;
+
+/**
+ * Wylicza wartości wielomianu w punktach zadania @p arg.
+ * @param[in,out] arg : wskaźnik na `AtManyTask`
+ * @return NULL
+ */
+static void *AtManyWorker(void *arg) {
+    AtManyTask *task = arg;
+
+    if (task->dense) {
+        MultipointEval(task->dense, task->length, task->x, task->count, task->values);
+    } else if (task->frozen) {
+        for (unsigned j = 0; j < task->count; ++j) {
+            task->out[j] = FrozenAt(task->frozen, task->x[j]);
+        }
+    } else {
+        for (unsigned j = 0; j < task->count; ++j) {
+            task->out[j] = PolyAt(task->p, task->x[j]);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Funkcja wątku roboczego `PolyAtMany`. Po wykonaniu zadania oddaje pamięć
+ * puli innym wątkom i zwalnia arenę wątku.
+ * @param[in,out] arg : wskaźnik na `AtManyTask`
+ * @return NULL
+ */
+static void *AtManyThread(void *arg) {
+    AtManyWorker(arg);
+    AllocThreadRelease();
+
+    return NULL;
+}
+
+/**
+ * Zwraca liczbę wątków, między które warto podzielić wyliczenie wartości
+ * wielomianu @p p w @p count punktach.
+ * @param[in] p : wielomian
+ * @param[in] count : liczba punktów
+ * @return liczba wątków, co najmniej 1
+ */
+static unsigned AtManyThreadCount(const Poly *p, unsigned count) {
+    size_t work = (size_t)count * PolyLeafCount(p) / AT_MANY_MIN_WORK_PER_THREAD;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t result = AT_MANY_MAX_THREADS;
+
+    if (cpus > 0 && (size_t)cpus < result) {
+        result = (size_t)cpus;
+    }
+
+    if (work < result) {
+        result = work;
+    }
+
+    if (count < result) {
+        result = count;
+    }
+
+    return result ? (unsigned)result : 1;
+}
+
+void PolyAtMany(const Poly *p, unsigned count, const poly_coeff_t x[], Poly out[]) {
+    if (PolyIsCoeff(p)) {
+        for (unsigned j = 0; j < count; ++j) {
+            out[j] = PolyClone(p);
+        }
+
+        return;
+    }
+
+    ArenaMark mark = ArenaSave();
+    poly_coeff_t *dense = NULL, *values = NULL;
+    size_t length = 0;
+
+    if (count >= MULTIPOINT_MIN_POINTS && PolyIsDense(p)) {
+        dense = PolyToDense(p, &length);
+        values = ArenaAlloc(sizeof(poly_coeff_t) * count);
+    }
+
+    // Wielomian czytany w wielu punktach zamrażamy, żeby wątki przechodziły
+    // po jednym ciągłym bloku pamięci zamiast po osobnych tablicach jednomianów.
+    FrozenPoly *frozen = (!dense && count > 1) ? PolyFreeze(p) : NULL;
+
+    AtManyTask tasks[AT_MANY_MAX_THREADS];
+    pthread_t threads[AT_MANY_MAX_THREADS];
+    bool started[AT_MANY_MAX_THREADS];
+    unsigned threadCount = AtManyThreadCount(p, count);
+    unsigned offset = 0;
+
+    for (unsigned t = 0; t < threadCount; ++t) {
+        unsigned size = count / threadCount + (t < count % threadCount);
+        tasks[t] = (AtManyTask) {.p = p, .dense = dense, .length = length,
+                                 .frozen = frozen, .x = x + offset, .count = size,
+                                 .values = values ? values + offset : NULL,
+                                 .out = out + offset};
+        offset += size;
+    }
+
+    // Wyniki wątków roboczych zwalnia później bieżący wątek, więc oddajemy
+    // wolne bloki wątkom roboczym, zamiast zbierać je tylko u siebie.
+    if (threadCount > 1) {
+        PoolShareFreeBlocks();
+    }
+
+    // Pierwszy fragment liczymy w bieżącym wątku; jeśli nie uda się utworzyć
+    // wątku, jego fragment również liczymy tutaj.
+    for (unsigned t = 1; t < threadCount; ++t) {
+        started[t] = !pthread_create(&threads[t], NULL, AtManyThread, &tasks[t]);
+    }
+
+    AtManyWorker(&tasks[0]);
+
+    for (unsigned t = 1; t < threadCount; ++t) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            AtManyWorker(&tasks[t]);
+        }
+    }
+
+    if (dense) {
+        for (unsigned j = 0; j < count; ++j) {
+            out[j] = PolyFromCoeff(values[j]);
+        }
+    }
+
+    FrozenDestroy(frozen);
+    ArenaRestore(mark);
+}
@@ -24,15 +24,19 @@ typedef struct Mono Mono;
  * Struktura przechowująca wielomian.
  * Wielomian może zależeć od jakichś zmiennych lub być współczynnikiem.
  * Jeśli wielomian nie jest współczynnikiem, to jest sumą jednomianów
- * zawartych w tablicy `monos` o rozmiarze `size` posortowanych niemalejąco
- * według stopni. Wówczas wartość pola `coeff` jest nieistotna.
- * Jeśli zaś wielomian jest współczynnikiem, to `monos == NULL`, a pole
- * `coeff` oznacza wartość współczynnika z którym mamy do czynienia.
- */
-typedef struct Poly {
-    Mono *monos; ///< tablica jednomianów
-    unsigned size; ///< rozmiar tablicy jednomianów
-    poly_coeff_t coeff; ///< współczynnik
+ * zawartych w tablicy `monos` o dodatnim rozmiarze `size` posortowanych
+ * niemalejąco według stopni.
+ * Jeśli zaś wielomian jest współczynnikiem, to `size == 0`, a pole `coeff`
+ * oznacza wartość współczynnika z którym mamy do czynienia.
+ * Pola `monos` i `coeff` dzielą pamięć, a struktura nie ma wyrównania do
+ * 8 bajtów, żeby jednomian z wykładnikiem zajmował 16 bajtów.
+ */
+typedef struct __attribute__((packed, aligned(4))) Poly {
+    union {
+        Mono *monos; ///< tablica jednomianów
+        poly_coeff_t coeff; ///< współczynnik
+    };
+    unsigned size; ///< rozmiar tablicy jednomianów albo 0 dla współczynnika
 } Poly;
 
 /**
@@ -40,8 +44,10 @@ typedef struct Poly {
   * Jednomian ma postać `p * x^e`.
   * Współczynnik `p` może też być wielomianem.
   * Będzie on traktowany jako wielomian nad kolejną zmienną (nie nad x).
+  * Tablice jednomianów są wyrównane do 8 bajtów, więc wskaźnik `p.monos`
+  * zawsze jest wyrównany.
   */
-typedef struct Mono {
+typedef struct __attribute__((aligned(8))) Mono {
     Poly p; ///< współczynnik
     poly_exp_t exp; ///< wykładnik
 } Mono;
@@ -52,7 +58,7 @@ typedef struct Mono {
  * @return wielomian
  */
 static inline Poly PolyFromCoeff(poly_coeff_t c) {
-    return (Poly) {.monos = NULL, .size = 0, .coeff = c};
+    return (Poly) {.coeff = c, .size = 0};
 }
 
 /**
@@ -69,7 +75,7 @@ static inline Poly PolyZero() {
  * @return Czy wielomian jest współczynnikiem?
  */
 static inline bool PolyIsCoeff(const Poly *p) {
-    return (p->monos == NULL);
+    return !p->size;
 }
 
 /**
@@ -93,7 +99,8 @@ static inline Mono MonoFromPoly(const Poly *p, poly_exp_t e) {
 }
 
 /**
- * Usuwa wielomian z pamięci.
+ * Usuwa wielomian z pamięci. Współdzielona tablica jednomianów jest zwalniana
+ * dopiero przez jej ostatniego właściciela.
  * @param[in] p : wielomian
  */
 void PolyDestroy(Poly *p);
@@ -107,14 +114,18 @@ static inline void MonoDestroy(Mono *m) {
 }
 
 /**
- * Robi pełną, głęboką kopię wielomianu.
+ * Robi kopię wielomianu w czasie stałym.
+ * Kopia współdzieli z oryginałem tablicę jednomianów, której licznik referencji
+ * jest zwiększany. Operacje modyfikujące wielomian w miejscu kopiują
+ * współdzieloną tablicę przed zapisem, więc kopia zachowuje się jak pełna,
+ * głęboka kopia.
  * @param[in] p : wielomian
  * @return skopiowany wielomian
  */
 Poly PolyClone(const Poly *p);
 
 /**
- * Robi pełną, głęboką kopię jednomianu.
+ * Robi kopię jednomianu w czasie stałym (zob. `PolyClone`).
  * @param[in] m : jednomian
  * @return skopiowany jednomian
  */
@@ -130,6 +141,17 @@ static inline Mono MonoClone(const Mono *m) {
  */
 Poly PolyAdd(const Poly *p, const Poly *q);
 
+/**
+ * Dodaje dwa wielomiany, przejmując na własność ich zawartość.
+ * Tablice jednomianów i poddrzewa współczynników @p p i @p q są wykorzystywane
+ * ponownie w wyniku zamiast być kopiowane. Po wywołaniu zawartość struktur
+ * wskazywanych przez @p p i @p q jest nieistotna.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p + q`
+ */
+Poly PolyAddOwned(Poly *p, Poly *q);
+
 /**
  * Sumuje listę jednomianów i tworzy z nich wielomian.
  * Przejmuje na własność zawartość tablicy @p monos.
@@ -139,6 +161,29 @@ Poly PolyAdd(const Poly *p, const Poly *q);
  */
 Poly PolyAddMonos(unsigned count, const Mono monos[]);
 
+/**
+ * Sumuje listę jednomianów i tworzy z nich wielomian tak jak `PolyAddMonos`,
+ * ale zamiast kopiować tablicę @p monos przejmuje ją na własność. Tablica
+ * musi pochodzić z puli (`PoolAlloc`) i może być większa niż @p count
+ * jednomianów.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+Poly PolyAddMonosOwned(unsigned count, Mono *monos);
+
+/**
+ * Tworzy wielomian z jednomianów o ściśle rosnących wykładnikach
+ * i niezerowych współczynnikach, przejmując na własność tablicę @p monos tak
+ * jak `PolyAddMonosOwned`. Jednomiany nie są sortowane ani sumowane,
+ * a tablica staje się tablicą jednomianów wyniku. Współczynnik będący stałą
+ * przy `x^0` musi mieć wykładnik -1, tak jak w `MonoFromPoly`.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+Poly PolyFromSortedMonosOwned(unsigned count, Mono *monos);
+
 /**
  * Mnoży dwa wielomiany.
  * @param[in] p : wielomian
@@ -147,6 +192,16 @@ Poly PolyAddMonos(unsigned count, const Mono monos[]);
  */
 Poly PolyMul(const Poly *p, const Poly *q);
 
+/**
+ * Mnoży dwa wielomiany, przejmując na własność ich zawartość.
+ * Po wywołaniu zawartość struktur wskazywanych przez @p p i @p q jest
+ * nieistotna.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p * q`
+ */
+Poly PolyMulOwned(Poly *p, Poly *q);
+
 /**
  * Zwraca przeciwny wielomian.
  * @param[in] p : wielomian
@@ -162,6 +217,68 @@ Poly PolyNeg(const Poly *p);
  */
 Poly PolySub(const Poly *p, const Poly *q);
 
+/**
+ * Odejmuje wielomian od wielomianu, przejmując na własność ich zawartość.
+ * Po wywołaniu zawartość struktur wskazywanych przez @p p i @p q jest
+ * nieistotna.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return `p - q`
+ */
+Poly PolySubOwned(Poly *p, Poly *q);
+
+/**
+ * Liczba kubełków akumulatora sumy. Kubełek `i` trzyma wielomian mający co
+ * najwyżej @f$4^{i+1}@f$ jednomianów.
+ */
+#define POLY_ACC_BUCKETS 16
+
+/**
+ * Akumulator sumy wielu wielomianów (geobukiety Yana). Dodawany wielomian
+ * trafia do kubełka odpowiadającego jego rozmiarowi i jest scalany tylko
+ * z wielomianami podobnej wielkości, więc suma @f$n@f$ wielomianów kosztuje
+ * @f$O(n \log n)@f$ zamiast @f$O(n^2)@f$ operacji na jednomianach, gdy
+ * wynik rośnie z każdym składnikiem.
+ * Wyzerowana struktura jest pustym akumulatorem.
+ */
+typedef struct PolyAccumulator {
+    Poly buckets[POLY_ACC_BUCKETS]; ///< kubełki; pusty kubełek trzyma zero
+    unsigned top; ///< liczba kubełków do najwyższego niepustego włącznie
+} PolyAccumulator;
+
+/**
+ * Tworzy pusty akumulator sumy.
+ * @return akumulator
+ */
+static inline PolyAccumulator AccCreate() {
+    return (PolyAccumulator) {.top = 0};
+}
+
+/**
+ * Dodaje wielomian @p p do akumulatora @p acc, przejmując na własność jego
+ * zawartość. Po wywołaniu zawartość struktury wskazywanej przez @p p jest
+ * nieistotna.
+ * @param[in,out] acc : akumulator
+ * @param[in] p : wielomian
+ */
+void AccAdd(PolyAccumulator *acc, Poly *p);
+
+/**
+ * Dodaje do akumulatora @p acc sumę jednomianów z tablicy @p monos, tak jak
+ * `PolyAddMonos` przejmując na własność ich zawartość.
+ * @param[in,out] acc : akumulator
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ */
+void AccAddMonos(PolyAccumulator *acc, unsigned count, const Mono monos[]);
+
+/**
+ * Zwraca sumę wielomianów dodanych do akumulatora @p acc i opróżnia go.
+ * @param[in,out] acc : akumulator
+ * @return suma
+ */
+Poly AccFinish(PolyAccumulator *acc);
+
 /**
  * Zwraca stopień wielomianu ze względu na zadaną zmienną (-1 dla wielomianu
  * tożsamościowo równego zeru).
@@ -169,6 +286,8 @@ Poly PolySub(const Poly *p, const Poly *q);
  * Zmienna o indeksie 0 oznacza zmienną główną tego wielomianu.
  * Większe indeksy oznaczają zmienne wielomianów znajdujących się
  * we współczynnikach.
+ * Stopnie są zapamiętywane w metadanych wielomianu, więc kolejne wywołania
+ * dla niezmienionego wielomianu działają w czasie stałym.
  * @param[in] p : wielomian
  * @param[in] var_idx : indeks zmiennej
  * @return stopień wielomianu @p p z względu na zmienną o indeksie @p var_idx
@@ -177,13 +296,33 @@ poly_exp_t PolyDegBy(const Poly *p, unsigned var_idx);
 
 /**
  * Zwraca stopień wielomianu (-1 dla wielomianu tożsamościowo równego zeru).
+ * Tak jak `PolyDegBy` korzysta z zapamiętanych metadanych.
  * @param[in] p : wielomian
  * @return stopień wielomianu @p p
  */
 poly_exp_t PolyDeg(const Poly *p);
 
+/**
+ * Zwraca liczbę zmiennych, od których może zależeć wielomian, czyli rozmiar
+ * wektora stopni `PolyDegBy(p, 0), PolyDegBy(p, 1), ...` bez końcowych zer.
+ * Dla współczynnika zwraca 0.
+ * @param[in] p : wielomian
+ * @return liczba zmiennych
+ */
+unsigned PolyVarCount(const Poly *p);
+
+/**
+ * Zwraca liczbę jednomianów wielomianu @p p po rozwinięciu, czyli liczbę
+ * jego niezerowych współczynników liczbowych.
+ * @param[in] p : wielomian
+ * @return liczba jednomianów
+ */
+size_t PolyTermCount(const Poly *p);
+
 /**
  * Sprawdza równość dwóch wielomianów.
+ * Wielomiany o różnych skrótach strukturalnych (zapamiętywanych tak jak
+ * stopnie) są odrzucane bez porównywania jednomianów.
  * @param[in] p : wielomian
  * @param[in] q : wielomian
  * @return `p = q`
@@ -203,6 +342,29 @@ bool PolyIsEq(const Poly *p, const Poly *q);
  */
 Poly PolyAt(const Poly *p, poly_coeff_t x);
 
+/**
+ * Wylicza wartość wielomianu @p p po podstawieniu `vals[0], ..., vals[n - 1]`
+ * pod zmienne `x_0, ..., x_{n - 1}` i zera pod pozostałe zmienne.
+ * Liczy w jednym przejściu rekurencyjnym bez alokacji pamięci.
+ * @param[in] p : wielomian
+ * @param[in] n : rozmiar tablicy @p vals
+ * @param[in] vals : tablica wartości zmiennych
+ * @return @f$p(vals[0], \ldots, vals[n - 1], 0, 0, \ldots)@f$
+ */
+poly_coeff_t PolyEvalAll(const Poly *p, unsigned n, const poly_coeff_t vals[]);
+
+/**
+ * Wylicza wartości wielomianu @p p w punktach `x[0], ..., x[count - 1]`.
+ * Wynik jest taki sam jak `PolyAt(p, x[i])` dla każdego `i`, ale wielomian
+ * gęsty jednej zmiennej jest wyliczany w wielu punktach naraz przy pomocy
+ * drzewa iloczynów, a punkty są dzielone między wątki robocze.
+ * @param[in] p : wielomian
+ * @param[in] count : liczba punktów
+ * @param[in] x : tablica punktów
+ * @param[out] out : tablica o rozmiarze @p count na wyniki
+ */
+void PolyAtMany(const Poly *p, unsigned count, const poly_coeff_t x[], Poly out[]);
+
 /**
  * Podstawia wielomiany `x[0], ..., x[count - 1]` pod zmienne wielomianu @p p.
  * @param[in] p : wielomian
@@ -212,4 +374,50 @@ Poly PolyAt(const Poly *p, poly_coeff_t x);
  */
 Poly PolyCompose(const Poly *p, unsigned count, const Poly x[]);
 
+/**
+ * Zwraca liczbę alokacji pamięci wykonanych dotąd przez moduł wielomianów.
+ * Służy do diagnostyki i testów regresji wydajnościowej.
+ * @return liczba alokacji
+ */
+size_t PolyAllocCount();
+
+/**
+ * Statystyki tablicy internowania wielomianów.
+ */
+typedef struct PolyInternStats {
+    size_t nodes; ///< liczba różnych węzłów obecnie w tablicy
+    size_t lookups; ///< liczba internowanych węzłów od włączenia trybu
+    size_t hits; ///< liczba węzłów zastąpionych istniejącym egzemplarzem
+} PolyInternStats;
+
+/**
+ * Internuje wielomian @p p: każdy jego węzeł, łącznie z nim samym, zastępuje
+ * jedynym egzemplarzem równego mu węzła z globalnej tablicy internowania.
+ * Równe zinternowane wielomiany mają tę samą tablicę jednomianów, więc
+ * `PolyIsEq` porównuje je w czasie stałym. Zinternowanej tablicy nikt nie
+ * modyfikuje; operacje modyfikujące wielomian w miejscu najpierw ją kopiują.
+ * @param[in,out] p : wielomian
+ */
+void PolyIntern(Poly *p);
+
+/**
+ * Włącza lub wyłącza tryb internowania wielomianów (hash-consing), w którym
+ * kalkulator internuje każdy wielomian wstawiany na stos. Włączenie trybu
+ * zeruje liczniki statystyk.
+ * @param[in] enabled : czy tryb ma być włączony?
+ */
+void PolySetHashCons(bool enabled);
+
+/**
+ * Sprawdza, czy tryb internowania wielomianów jest włączony.
+ * @return czy tryb jest włączony?
+ */
+bool PolyHashConsEnabled();
+
+/**
+ * Zwraca statystyki tablicy internowania.
+ * @return statystyki
+ */
+PolyInternStats PolyGetInternStats();
+
 #endif /* __POLY_H__ */
\ No newline at end of file
@@ -7,9 +7,9 @@
 */
 
 #include <stdio.h>
-#include <assert.h>
 #include <stdlib.h>
 
+#include "allocator.h"
 #include "polystack.h"
 #include "utils.h"
 
@@ -44,8 +44,11 @@ void StackInit() {
 }
 
 void StackPush(Poly p) {
-    Node *n = malloc(sizeof(Node));
-    assert(n != NULL);
+    if (PolyHashConsEnabled()) {
+        PolyIntern(&p);
+    }
+
+    Node *n = PoolAlloc(sizeof(Node));
     n->p = p;
     n->next = s.head;
 
@@ -60,7 +63,7 @@ Poly StackPop() {
         s.size--;
 
         Poly result = n->p;
-        free(n);
+        PoolFree(n);
 
         return result;
     } else {
@@ -105,22 +108,16 @@ void StackAdd() {
     Poly p1 = StackPop();
     Poly p2 = StackPop();
 
-    Poly toPush = PolyAdd(&p1, &p2);
+    Poly toPush = PolyAddOwned(&p1, &p2);
     StackPush(toPush);
-
-    PolyDestroy(&p1);
-    PolyDestroy(&p2);
 }
 
 void StackMul() {
     Poly p1 = StackPop();
     Poly p2 = StackPop();
 
-    Poly toPush = PolyMul(&p1, &p2);
+    Poly toPush = PolyMulOwned(&p1, &p2);
     StackPush(toPush);
-
-    PolyDestroy(&p1);
-    PolyDestroy(&p2);
 }
 
 void StackNeg() {
@@ -129,17 +126,18 @@ void StackNeg() {
 
     PolyDestroy(&n->p);
     n->p = p;
+
+    if (PolyHashConsEnabled()) {
+        PolyIntern(&n->p);
+    }
 }
 
 void StackSub() {
     Poly p1 = StackPop();
     Poly p2 = StackPop();
 
-    Poly toPush = PolySub(&p1, &p2);
+    Poly toPush = PolySubOwned(&p1, &p2);
     StackPush(toPush);
-
-    PolyDestroy(&p1);
-    PolyDestroy(&p2);
 }
 
 bool StackIsEq() {
@@ -154,6 +152,19 @@ poly_exp_t StackDegBy(unsigned var_idx) {
     return PolyDegBy(&s.head->p, var_idx);
 }
 
+void StackPrintDegs() {
+    const Poly *p = &s.head->p;
+    unsigned vars = PolyVarCount(p);
+
+    printf("%d", PolyDegBy(p, 0));
+
+    for (unsigned j = 1; j < vars; ++j) {
+        printf(" %d", PolyDegBy(p, j));
+    }
+
+    printf("\n");
+}
+
 void StackAt(poly_coeff_t x) {
     Poly p = StackPop();
 
@@ -163,6 +174,33 @@ void StackAt(poly_coeff_t x) {
     PolyDestroy(&p);
 }
 
+void StackAtMany(unsigned count, const poly_coeff_t x[]) {
+    Poly p = StackPop();
+
+    if (count) {
+        ArenaMark mark = ArenaSave();
+        Poly *values = ArenaAlloc(count * sizeof(Poly));
+
+        PolyAtMany(&p, count, x, values);
+
+        for (unsigned j = count; j > 0; --j) {
+            StackPush(values[j - 1]);
+        }
+
+        ArenaRestore(mark);
+    }
+
+    PolyDestroy(&p);
+}
+
+void StackAtVars(unsigned count, const poly_coeff_t vals[]) {
+    Poly p = StackPop();
+
+    StackPush(PolyFromCoeff(PolyEvalAll(&p, count, vals)));
+
+    PolyDestroy(&p);
+}
+
 /**
  * Wypisuje rekurencyjnie wielomian @p p.
  * @param[in] p : wielomian
@@ -175,7 +213,8 @@ void PolyPrint(const Poly *p);
  */
 void MonoPrint(const Mono *m) {
     PolyPrint(&m->p);
-    printf(",%d", m->exp);
+    // Wyraz wolny (wykładnik -1) wypisujemy z wykładnikiem 0.
+    printf(",%d", (m->exp < 0) ? 0 : m->exp);
 }
 
 void PolyPrint(const Poly *p) {
@@ -185,15 +224,11 @@ void PolyPrint(const Poly *p) {
         Poly toPrint = PolyClone(p);
 
         if (toPrint.size > 1) {
-            if (toPrint.monos[0].exp == -1 && toPrint.monos[1].exp > 0) {
-                toPrint.monos[0].exp = 0;
-            } else if (toPrint.monos[0].exp == -1) {
+            if (toPrint.monos[0].exp == -1 && toPrint.monos[1].exp == 0) {
                 Poly subtrahend = toPrint.monos[0].p;
 
                 Poly tmp = PolySub(&toPrint, &subtrahend);
-                Poly coeffWrapper = (Poly) {.monos = malloc(sizeof(Mono)), .size = 1,
-                        .coeff = 0};
-                assert(coeffWrapper.monos != NULL);
+                Poly coeffWrapper = (Poly) {.monos = PoolAlloc(sizeof(Mono)), .size = 1};
                 Mono m = MonoFromPoly(&subtrahend, 0);
                 m.exp = 0;
                 coeffWrapper.monos[0] = m;
@@ -227,6 +262,22 @@ void StackPrint() {
     }
 }
 
+void StackHashCons() {
+    PolySetHashCons(true);
+
+    for (Node *n = s.head; n != NULL; n = n->next) {
+        PolyIntern(&n->p);
+    }
+}
+
+void StackPrintInternStats() {
+    PolyInternStats stats = PolyGetInternStats();
+    size_t inserted = stats.lookups - stats.hits;
+
+    printf("nodes %zu lookups %zu hits %zu ratio %.2f\n", stats.nodes, stats.lookups,
+           stats.hits, inserted ? (double)stats.lookups / inserted : 1.0);
+}
+
 void StackCompose(unsigned count) {
     Poly p = StackPop();
 
@@ -234,8 +285,8 @@ void StackCompose(unsigned count) {
         Poly tmp = PolyCompose(&p, 0, NULL);
         StackPush(tmp);
     } else {
-        Poly *x = malloc(count * sizeof(Poly));
-        assert(x != NULL);
+        ArenaMark mark = ArenaSave();
+        Poly *x = ArenaAlloc(count * sizeof(Poly));
 
         for (unsigned j = 0; j < count; ++j) {
             x[j] = StackPop();
@@ -247,7 +298,7 @@ void StackCompose(unsigned count) {
         for (unsigned j = 0; j < count; ++j) {
             PolyDestroy(&x[j]);
         }
-        free(x);
+        ArenaRestore(mark);
     }
 
     PolyDestroy(&p);
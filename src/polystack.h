@@ -113,6 +113,14 @@ poly_exp_t StackDeg();
  */
 poly_exp_t StackDegBy(unsigned var_idx);
 
+/**
+ * Wypisuje na standardowe wyjście stopnie wielomianu ze szczytu stosu ze
+ * względu na kolejne zmienne `x_0, ..., x_{k - 1}` (zob. `PolyVarCount`),
+ * oddzielone spacjami. Dla współczynnika wypisuje tylko stopień ze względu
+ * na `x_0`.
+ */
+void StackPrintDegs();
+
 /**
  * Wylicza wartość wielomianu w punkcie `x`, usuwa wielomian z wierzchołka
  * i wstawia na stos wynik operacji.
@@ -120,6 +128,24 @@ poly_exp_t StackDegBy(unsigned var_idx);
  */
 void StackAt(poly_coeff_t x);
 
+/**
+ * Wylicza wartości wielomianu z wierzchołka stosu w punktach `x[0], ...,
+ * x[count - 1]`, usuwa wielomian z wierzchołka i wstawia na stos wyniki tak,
+ * że na wierzchołku znajduje się wartość w punkcie `x[0]`.
+ * @param[in] count : liczba punktów
+ * @param[in] x : tablica punktów
+ */
+void StackAtMany(unsigned count, const poly_coeff_t x[]);
+
+/**
+ * Podstawia wartości `vals[0], ..., vals[count - 1]` pod kolejne zmienne
+ * wielomianu z wierzchołka stosu (a zero pod pozostałe), usuwa wielomian
+ * z wierzchołka i wstawia na stos otrzymany współczynnik.
+ * @param[in] count : liczba wartości
+ * @param[in] vals : tablica wartości
+ */
+void StackAtVars(unsigned count, const poly_coeff_t vals[]);
+
 /**
  * Wypisuje na standardowe wyjście wielomian z wierzchołka stosu w formacie
  * akceptowanym przez parser.
@@ -134,4 +160,19 @@ void StackPrint();
  */
 void StackCompose(unsigned count);
 
+/**
+ * Włącza tryb internowania wielomianów (zob. `PolyIntern`) i internuje
+ * wielomiany obecne na stosie. Od tej chwili każdy wielomian wstawiany na stos
+ * jest internowany.
+ */
+void StackHashCons();
+
+/**
+ * Wypisuje na standardowe wyjście statystyki tablicy internowania: liczbę
+ * różnych węzłów w tablicy, liczbę internowanych węzłów, liczbę węzłów
+ * zastąpionych istniejącym egzemplarzem i współczynnik deduplikacji (liczba
+ * internowanych węzłów na jeden wpisany do tablicy).
+ */
+void StackPrintInternStats();
+
 #endif /* __POLYSTACK_H__ */
\ No newline at end of file
@@ -0,0 +1,83 @@
+/** @file
+   Potęgi podstawianej wartości przy wartościowaniu wielomianów
+
+   Wartościowanie przechodzi jednomiany rosnąco po wykładnikach, więc kolejną
+   potęgę liczymy z poprzedniej, podnosząc wartość tylko do różnicy
+   wykładników. Wyraz wolny (wykładnik -1) ma potęgę zerową. Gdy potęga się
+   wyzeruje, wszystkie dalsze też są zerami i przejście można przerwać.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#ifndef __POWER_H__
+#define __POWER_H__
+
+#include "poly.h"
+
+/**
+ * Zwraca współczynnik @p coeff podniesiony do potęgi @p exp, a dla wykładnika
+ * niedodatniego 1.
+ * @param[in] coeff : współczynnik
+ * @param[in] exp : wykładnik
+ * @return `coeff^exp`
+ */
+static inline poly_coeff_t CoeffPower(poly_coeff_t coeff, poly_exp_t exp) {
+    poly_coeff_t result = 1;
+
+    while (exp > 0) {
+        if (exp & 1) {
+            result *= coeff;
+        }
+
+        exp >>= 1;
+        coeff *= coeff;
+    }
+
+    return result;
+}
+
+/**
+ * Stan przejścia po kolejnych potęgach podstawianej wartości.
+ */
+typedef struct PowerWalk {
+    poly_coeff_t x; ///< podstawiana wartość
+    poly_coeff_t power; ///< potęga przy ostatnim wykładniku
+    poly_exp_t lastExp; ///< ostatni wykładnik
+} PowerWalk;
+
+/**
+ * Rozpoczyna przejście po potęgach wartości @p x.
+ * @param[in] x : podstawiana wartość
+ * @return stan przejścia
+ */
+static inline PowerWalk PowerWalkStart(poly_coeff_t x) {
+    return (PowerWalk) {.x = x, .power = 1, .lastExp = 0};
+}
+
+/**
+ * Sprawdza, czy w przejściu @p w mogą jeszcze wystąpić niezerowe potęgi.
+ * @param[in] w : stan przejścia
+ * @return czy ostatnia potęga jest niezerowa?
+ */
+static inline bool PowerWalkLive(const PowerWalk *w) {
+    return w->power != 0;
+}
+
+/**
+ * Przechodzi do jednomianu o wykładniku @p exp, nie mniejszym od wykładników
+ * poprzednich jednomianów, i zwraca odpowiadającą mu potęgę.
+ * @param[in,out] w : stan przejścia
+ * @param[in] exp : wykładnik jednomianu
+ * @return `x^exp`, a dla wyrazu wolnego 1
+ */
+static inline poly_coeff_t PowerWalkNext(PowerWalk *w, poly_exp_t exp) {
+    exp = exp < 0 ? 0 : exp;
+    w->power *= CoeffPower(w->x, exp - w->lastExp);
+    w->lastExp = exp;
+
+    return w->power;
+}
+
+#endif /* __POWER_H__ */
@@ -0,0 +1,166 @@
+/** @file
+   Testy puli pamięci używanej przez wiele wątków
+
+   W przeciwieństwie do `unit_tests_poly.c` ten program jest kompilowany bez
+   `UNIT_TESTING`, więc pula korzysta z płyt i list wolnych bloków, a
+   `PolyAtMany` może dzielić pracę między wątki.
+
+   @author Antoni Zawodny <az337756@students.mimuw.edu.pl>
+   @copyright Uniwersytet Warszawski
+   @date 2017-05-22
+*/
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+#include "allocator.h"
+#include "cmocka.h"
+#include "poly.h"
+
+/**
+ * Liczba powtórzeń operacji wielowątkowej w każdym teście.
+ */
+#define ROUNDS 400
+
+/**
+ * Liczba wątków roboczych w każdym powtórzeniu.
+ */
+#define WORKERS 4
+
+/**
+ * Liczba wielomianów tworzonych przez jeden wątek roboczy.
+ */
+#define WORKER_POLYS 64
+
+/**
+ * Tworzy wielomian o głębokości @p depth, w którym każdy wielomian niebędący
+ * współczynnikiem ma @p width jednomianów.
+ * @param[in] depth : głębokość wielomianu
+ * @param[in] width : liczba jednomianów
+ * @param[in] seed : ziarno współczynników
+ * @return wielomian
+ */
+static Poly WidePoly(unsigned depth, unsigned width, poly_coeff_t seed) {
+    if (!depth) {
+        return PolyFromCoeff(1 + seed % 9);
+    }
+
+    Mono monos[width];
+
+    for (unsigned j = 0; j < width; ++j) {
+        Poly c = WidePoly(depth - 1, width, seed * 31 + j);
+        monos[j] = MonoFromPoly(&c, (poly_exp_t)j + 1);
+    }
+
+    return PolyAddMonos(width, monos);
+}
+
+/**
+ * Funkcja wątku roboczego: tworzy wielomiany, z których część niszczy sam,
+ * a resztę przekazuje wątkowi głównemu, tak jak wątki `PolyAtMany`.
+ * @param[out] arg : tablica `WORKER_POLYS` wielomianów
+ * @return NULL
+ */
+static void *Worker(void *arg) {
+    Poly *out = arg;
+
+    for (unsigned j = 0; j < WORKER_POLYS; ++j) {
+        Poly tmp = WidePoly(2, 5, j);
+        out[j] = WidePoly(2, 3, j);
+        PolyDestroy(&tmp);
+    }
+
+    AllocThreadRelease();
+
+    return NULL;
+}
+
+/**
+ * Test oddawania pamięci przez kończące się wątki: powtarzane uruchamianie
+ * wątków, których wyniki zwalnia wątek główny, nie zwiększa bez końca
+ * rozmiaru płyt puli.
+ * @param state : stan
+ */
+static void TestThreadReleaseReusesSlabs(void **state) {
+    (void)state;
+
+    Poly out[WORKERS][WORKER_POLYS];
+    pthread_t threads[WORKERS];
+    size_t warmSlabBytes = 0;
+
+    for (unsigned round = 0; round < ROUNDS; ++round) {
+        for (unsigned t = 0; t < WORKERS; ++t) {
+            assert_int_equal(pthread_create(&threads[t], NULL, Worker, out[t]), 0);
+        }
+
+        for (unsigned t = 0; t < WORKERS; ++t) {
+            pthread_join(threads[t], NULL);
+
+            for (unsigned j = 0; j < WORKER_POLYS; ++j) {
+                PolyDestroy(&out[t][j]);
+            }
+        }
+
+        // Tak jak `PolyAtMany` oddajemy bloki wyników kolejnym wątkom.
+        PoolShareFreeBlocks();
+
+        if (round == ROUNDS / 10) {
+            warmSlabBytes = AllocGetStats().slabBytes;
+        }
+    }
+
+    assert_true(AllocGetStats().slabBytes <= 2 * warmSlabBytes);
+}
+
+/**
+ * Test powtarzanego `PolyAtMany` z wielomianem wielu zmiennych, którego
+ * wartości są niszczone po każdym wywołaniu: rozmiar płyt puli się
+ * stabilizuje. Na maszynie z jednym procesorem `PolyAtMany` liczy w jednym
+ * wątku.
+ * @param state : stan
+ */
+static void TestAtManyReusesSlabs(void **state) {
+    (void)state;
+
+    Poly p = WidePoly(4, 7, 1);
+    poly_coeff_t x[300];
+    Poly out[300];
+    size_t warmSlabBytes = 0;
+
+    for (unsigned j = 0; j < 300; ++j) {
+        x[j] = (poly_coeff_t)j % 11 - 5;
+    }
+
+    for (unsigned round = 0; round < ROUNDS / 4; ++round) {
+        PolyAtMany(&p, 300, x, out);
+
+        for (unsigned j = 0; j < 300; ++j) {
+            PolyDestroy(&out[j]);
+        }
+
+        if (round == ROUNDS / 40) {
+            warmSlabBytes = AllocGetStats().slabBytes;
+        }
+    }
+
+    assert_true(AllocGetStats().slabBytes <= 2 * warmSlabBytes);
+    PolyDestroy(&p);
+}
+
+/**
+ * Funkcja główna testów puli.
+ * @return kod wyjścia programu
+ */
+int main(void) {
+    const struct CMUnitTest AllocatorThreadTests[] = {
+            cmocka_unit_test(TestThreadReleaseReusesSlabs),
+            cmocka_unit_test(TestAtManyReusesSlabs)
+    };
+
+    int result = cmocka_run_group_tests(AllocatorThreadTests, NULL, NULL);
+    AllocRelease();
+
+    return result;
+}
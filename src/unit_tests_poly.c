@@ -16,11 +16,14 @@
  * limitations under the License.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 #include <setjmp.h>
 
+#include "allocator.h"
 #include "cmocka.h"
+#include "frozen.h"
 #include "poly.h"
 
 int mock_fprintf(FILE* const file, const char *format, ...) CMOCKA_PRINTF_ATTRIBUTE(2, 3);
@@ -36,6 +39,7 @@ static int fprintf_position = 0;
 static int printf_position = 0;
 
 extern int mock_main();
+extern void PolyPrint(const Poly *p);
 
 /**
  * Atrapa funkcji fprintf sprawdzająca poprawność wypisywania na stderr.
@@ -280,6 +284,37 @@ static void TestComposeIdentityIdentity(void **state) {
     PolyDestroy(&x[0]);
 }
 
+/**
+ * Test funkcji PolyCompose dla `p = x_0^4 + 2 * x_0 + 3` i `x[0] = x_0 + 1`.
+ * Kolejne potęgi `x[0]` są brane z pamięci podręcznej potęg.
+ * @param state : stan
+ */
+static void TestComposePowers(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly two = PolyFromCoeff(2);
+    Poly three = PolyFromCoeff(3);
+    Poly four = PolyFromCoeff(4);
+    Poly six = PolyFromCoeff(6);
+    Mono pMonos[3] = {MonoFromPoly(&one, 4), MonoFromPoly(&two, 1), MonoFromPoly(&three, 0)};
+    Mono xMonos[2] = {MonoFromPoly(&one, 1), MonoFromPoly(&one, 0)};
+    Mono expectedMonos[5] = {MonoFromPoly(&one, 4), MonoFromPoly(&four, 3), MonoFromPoly(&six, 2),
+                             MonoFromPoly(&six, 1), MonoFromPoly(&six, 0)};
+    Poly p = PolyAddMonos(3, pMonos);
+    Poly x[1] = {PolyAddMonos(2, xMonos)};
+    Poly expectedRes = PolyAddMonos(5, expectedMonos);
+
+    Poly res = PolyCompose(&p, 1, x);
+
+    assert_true(PolyIsEq(&expectedRes, &res));
+
+    PolyDestroy(&p);
+    PolyDestroy(&x[0]);
+    PolyDestroy(&res);
+    PolyDestroy(&expectedRes);
+}
+
 /**
  * Test parsowania polecenia COMPOSE bez argumentu.
  * @param state : stan
@@ -379,6 +414,810 @@ static void TestComposeParameterAlphanumeric(void **state) {
     assert_string_equal(fprintf_buffer, "ERROR 2 WRONG COUNT\n");
 }
 
+/**
+ * Test rozpoznawania komend będących prefiksami innych komend oraz nazw, które
+ * są tylko prefiksami albo przedłużeniami nazw komend.
+ * @param state : stan
+ */
+static void TestParseCommandPrefixes(void **state) {
+    (void)state;
+
+    init_input_stream("1\nDEG\nDEGS\nDEG_BY 0\nDEGX\nDEG_B 0\nDE\nPRINT 1\nAT\nzero\nIS_ZERO");
+    assert_int_equal(mock_main(), 0);
+    assert_string_equal(printf_buffer, "0\n0\n0\n0\n");
+    assert_string_equal(fprintf_buffer, "ERROR 5 WRONG COMMAND\nERROR 6 WRONG COMMAND\n"
+                                        "ERROR 7 WRONG COMMAND\nERROR 8 WRONG COMMAND\n"
+                                        "ERROR 9 WRONG COMMAND\nERROR 10 WRONG COMMAND\n");
+}
+
+/**
+ * Test parsowania współczynników i wykładników na granicach ich typów.
+ * Przekroczenie zakresu jest zgłaszane w kolumnie cyfry, która go przekroczyła.
+ * @param state : stan
+ */
+static void TestParseNumberLimits(void **state) {
+    (void)state;
+
+    init_input_stream("9223372036854775807\nPRINT\n-9223372036854775808\nPRINT\n"
+                      "9223372036854775808\n(1,2147483648)\n"
+                      "(-12345678901234567,2147483647)\nPRINT");
+    assert_int_equal(mock_main(), 0);
+    assert_string_equal(printf_buffer, "9223372036854775807\n-9223372036854775808\n"
+                                       "(-12345678901234567,2147483647)\n");
+    assert_string_equal(fprintf_buffer, "ERROR 5 19\nERROR 6 13\n");
+}
+
+/**
+ * Test funkcji PolyMul dla `p = x_0 + 1` i `q = x_0 - 1`.
+ * @param state : stan
+ */
+static void TestMulDifferenceOfSquares(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly minusOne = PolyFromCoeff(-1);
+    Mono pMonos[2] = {MonoFromPoly(&one, 1), MonoFromPoly(&one, 0)};
+    Mono qMonos[2] = {MonoFromPoly(&one, 1), MonoFromPoly(&minusOne, 0)};
+    Mono expectedMonos[2] = {MonoFromPoly(&one, 2), MonoFromPoly(&minusOne, 0)};
+    Poly p = PolyAddMonos(2, pMonos);
+    Poly q = PolyAddMonos(2, qMonos);
+    Poly expectedRes = PolyAddMonos(2, expectedMonos);
+
+    Poly res = PolyMul(&p, &q);
+
+    assert_true(PolyIsEq(&expectedRes, &res));
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&res);
+    PolyDestroy(&expectedRes);
+}
+
+/**
+ * Test funkcji PolyMul dla `p = x_0 * x_1 + x_0` i `q = x_0^2 + x_1`.
+ * Sprawdza sumowanie iloczynów o równych wykładnikach na kolejnych poziomach
+ * rekurencji.
+ * @param state : stan
+ */
+static void TestMulMultivariate(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Mono x1Monos[1] = {MonoFromPoly(&one, 1)};
+    Poly x1 = PolyAddMonos(1, x1Monos);
+    Mono x1PlusOneMonos[2] = {MonoFromPoly(&one, 1), MonoFromPoly(&one, 0)};
+    Poly x1PlusOne = PolyAddMonos(2, x1PlusOneMonos);
+    Poly x1Copy = PolyClone(&x1);
+
+    Mono pMonos[1] = {MonoFromPoly(&x1PlusOne, 1)};
+    Mono qMonos[2] = {MonoFromPoly(&one, 2), MonoFromPoly(&x1, 0)};
+    Poly p = PolyAddMonos(1, pMonos);
+    Poly q = PolyAddMonos(2, qMonos);
+
+    Poly x1Squared = PolyMul(&x1Copy, &x1Copy);
+    Poly x1Sum = PolyAdd(&x1Squared, &x1Copy);
+    Poly x1PlusOneCopy = PolyAdd(&x1Copy, &one);
+    Mono expectedMonos[2] = {MonoFromPoly(&x1PlusOneCopy, 3), MonoFromPoly(&x1Sum, 1)};
+    Poly expectedRes = PolyAddMonos(2, expectedMonos);
+
+    Poly res = PolyMul(&p, &q);
+
+    assert_true(PolyIsEq(&expectedRes, &res));
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&res);
+    PolyDestroy(&expectedRes);
+    PolyDestroy(&x1Copy);
+    PolyDestroy(&x1Squared);
+}
+
+/**
+ * Sprawdza iloczyn `p * p` dla `p = 1 + x_0 + ... + x_0^{n - 1}`.
+ * @param n : liczba jednomianów `p`
+ */
+static void CheckMulAllOnes(unsigned n) {
+    Mono *monos = malloc(sizeof(Mono) * n);
+    assert_true(monos != NULL);
+
+    for (unsigned j = 0; j < n; ++j) {
+        Poly one = PolyFromCoeff(1);
+        monos[j] = MonoFromPoly(&one, j);
+    }
+
+    Poly p = PolyAddMonos(n, monos);
+    Poly res = PolyMul(&p, &p);
+
+    assert_int_equal(PolyDeg(&res), 2 * n - 2);
+
+    for (unsigned j = 0; j < 2 * n - 1; ++j) {
+        poly_coeff_t expected = (j < n) ? j + 1 : 2 * n - 1 - j;
+        assert_true(PolyIsCoeff(&res.monos[j].p));
+        assert_int_equal(res.monos[j].p.coeff, expected);
+    }
+
+    free(monos);
+    PolyDestroy(&p);
+    PolyDestroy(&res);
+}
+
+/**
+ * Test funkcji PolyMul dla gęstego wielomianu jednej zmiennej, który
+ * przechodzi przez mnożenie algorytmem Karacuby lub Toom-3.
+ * @param state : stan
+ */
+static void TestMulDense(void **state) {
+    (void)state;
+
+    CheckMulAllOnes(1000);
+}
+
+/**
+ * Test funkcji PolyMul dla gęstego wielomianu jednej zmiennej, który
+ * przechodzi przez mnożenie transformatą teorioliczbową.
+ * @param state : stan
+ */
+static void TestMulNtt(void **state) {
+    (void)state;
+
+    CheckMulAllOnes(3000);
+}
+
+/**
+ * Test funkcji PolyMul dla gęstego wielomianu dwóch zmiennych
+ * `p = (1 + x_0 + ... + x_0^7) * (1 + x_1 + ... + x_1^7)`, który przechodzi
+ * przez podstawienie Kroneckera.
+ * @param state : stan
+ */
+static void TestMulKronecker(void **state) {
+    (void)state;
+
+    const unsigned n = 8;
+    Mono inner[8], outer[8];
+
+    for (unsigned j = 0; j < n; ++j) {
+        Poly one = PolyFromCoeff(1);
+        inner[j] = MonoFromPoly(&one, j);
+    }
+
+    Poly x1Sum = PolyAddMonos(n, inner);
+
+    for (unsigned j = 0; j < n; ++j) {
+        Poly c = PolyClone(&x1Sum);
+        outer[j] = MonoFromPoly(&c, j);
+    }
+
+    Poly p = PolyAddMonos(n, outer);
+    Poly res = PolyMul(&p, &p);
+
+    assert_int_equal(PolyDegBy(&res, 0), 2 * n - 2);
+    assert_int_equal(PolyDegBy(&res, 1), 2 * n - 2);
+
+    Poly atOne = PolyAt(&res, 1);
+    Poly atOneOne = PolyAt(&atOne, 1);
+    Poly atMinusOne = PolyAt(&res, -1);
+    Poly atMinusOneMinusOne = PolyAt(&atMinusOne, -1);
+
+    assert_true(PolyIsCoeff(&atOneOne));
+    assert_int_equal(atOneOne.coeff, n * n * n * n);
+    assert_true(PolyIsZero(&atMinusOneMinusOne));
+
+    PolyDestroy(&x1Sum);
+    PolyDestroy(&p);
+    PolyDestroy(&res);
+    PolyDestroy(&atOne);
+    PolyDestroy(&atOneOne);
+    PolyDestroy(&atMinusOne);
+    PolyDestroy(&atMinusOneMinusOne);
+}
+
+/**
+ * Test funkcji PolyAddOwned dla `p = x_0^2 + x_0 + 1` i `q = -x_0 + 3`.
+ * Sprawdza usuwanie jednomianów, które się znoszą.
+ * @param state : stan
+ */
+static void TestAddOwnedCancellation(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly minusOne = PolyFromCoeff(-1);
+    Poly three = PolyFromCoeff(3);
+    Poly four = PolyFromCoeff(4);
+    Mono pMonos[3] = {MonoFromPoly(&one, 2), MonoFromPoly(&one, 1), MonoFromPoly(&one, 0)};
+    Mono qMonos[2] = {MonoFromPoly(&minusOne, 1), MonoFromPoly(&three, 0)};
+    Mono expectedMonos[2] = {MonoFromPoly(&one, 2), MonoFromPoly(&four, 0)};
+    Poly p = PolyAddMonos(3, pMonos);
+    Poly q = PolyAddMonos(2, qMonos);
+    Poly expectedRes = PolyAddMonos(2, expectedMonos);
+
+    Poly res = PolyAddOwned(&p, &q);
+
+    assert_true(PolyIsEq(&expectedRes, &res));
+
+    PolyDestroy(&res);
+    PolyDestroy(&expectedRes);
+}
+
+/**
+ * Test funkcji PolyAddMonos dla jednomianów `x_1 * x_0^0`, `(-x_1 + 3) * x_0^0`
+ * i `x_0`: współczynniki przy `x_0^0` sumują się do liczby 3, która musi
+ * trafić do wyrazu wolnego.
+ * @param state : stan
+ */
+static void TestAddMonosCancelToCoeff(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly minusOne = PolyFromCoeff(-1);
+    Poly three = PolyFromCoeff(3);
+    Mono x1Monos[1] = {MonoFromPoly(&one, 1)};
+    Mono qMonos[2] = {MonoFromPoly(&minusOne, 1), MonoFromPoly(&three, 0)};
+    Poly x1 = PolyAddMonos(1, x1Monos);
+    Poly q = PolyAddMonos(2, qMonos);
+    Mono monos[3] = {MonoFromPoly(&x1, 0), MonoFromPoly(&q, 0), MonoFromPoly(&one, 1)};
+
+    Poly res = PolyAddMonos(2, monos);
+    assert_true(PolyIsCoeff(&res));
+    assert_int_equal(res.coeff, 3);
+
+    x1 = PolyAddMonos(1, x1Monos);
+    q = PolyAddMonos(2, qMonos);
+    monos[0] = MonoFromPoly(&x1, 0);
+    monos[1] = MonoFromPoly(&q, 0);
+    res = PolyAddMonos(3, monos);
+    assert_int_equal(PolyDeg(&res), 1);
+    assert_int_equal(PolyTermCount(&res), 2);
+    assert_int_equal(PolyEvalAll(&res, 1, (poly_coeff_t[]) {5}), 8);
+
+    PolyDestroy(&res);
+}
+
+/**
+ * Tworzy wielomian `x_0 * (x_1 * (... * (x_{depth - 1} + 1) ...) + 1) + 1`.
+ * @param depth : głębokość wielomianu
+ * @return wielomian
+ */
+static Poly DeepChainPoly(unsigned depth) {
+    Poly p = PolyFromCoeff(1);
+
+    for (unsigned j = 0; j < depth; ++j) {
+        Poly one = PolyFromCoeff(1);
+        Mono m[2] = {MonoFromPoly(&one, 0), MonoFromPoly(&p, 1)};
+        p = PolyAddMonos(2, m);
+    }
+
+    return p;
+}
+
+/**
+ * Test regresji liczby alokacji w funkcji PolyAdd dla głębokich wielomianów.
+ * Suma powinna być liczona raz na każdym poziomie, bez tymczasowych kopii
+ * współczynników, więc liczba alokacji ma być liniowa względem głębokości.
+ * @param state : stan
+ */
+static void TestAddDeepAllocCount(void **state) {
+    (void)state;
+
+    const unsigned depth = 20;
+    Poly p = DeepChainPoly(depth);
+    Poly q = PolyNeg(&p);
+
+    size_t allocCount = PolyAllocCount();
+    Poly zero = PolyAdd(&p, &q);
+    assert_true(PolyIsZero(&zero));
+    assert_true(PolyAllocCount() - allocCount <= depth);
+
+    allocCount = PolyAllocCount();
+    Poly doubled = PolyAdd(&p, &p);
+    assert_true(PolyAllocCount() - allocCount <= 2 * depth);
+    assert_int_equal(PolyDeg(&doubled), depth);
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&doubled);
+}
+
+/**
+ * Test regresji liczby alokacji w funkcji PolyMulOwned dla stałej i głębokiego
+ * wielomianu. Niewspółdzielony wielomian jest mnożony w miejscu, a kopia
+ * współdzieląca tablice z oryginałem kopiuje każdą z nich dokładnie raz.
+ * @param state : stan
+ */
+static void TestScalarMulAllocCount(void **state) {
+    (void)state;
+
+    const unsigned depth = 20;
+    poly_coeff_t ones[20];
+
+    for (unsigned j = 0; j < depth; ++j) {
+        ones[j] = 1;
+    }
+
+    Poly p = DeepChainPoly(depth);
+    Poly three = PolyFromCoeff(3);
+
+    size_t allocCount = PolyAllocCount();
+    p = PolyMulOwned(&three, &p);
+    assert_int_equal(PolyAllocCount(), allocCount);
+    assert_int_equal(PolyEvalAll(&p, depth, ones), 3 * (depth + 1));
+
+    Poly c = PolyClone(&p);
+    allocCount = PolyAllocCount();
+    c = PolyMulOwned(&three, &c);
+    assert_int_equal(PolyAllocCount() - allocCount, depth);
+    assert_int_equal(PolyEvalAll(&c, depth, ones), 9 * (depth + 1));
+    assert_int_equal(PolyEvalAll(&p, depth, ones), 3 * (depth + 1));
+
+    PolyDestroy(&p);
+    PolyDestroy(&c);
+}
+
+/**
+ * Tworzy wielomian jednej zmiennej o wykładnikach `start + k * step` dla
+ * `k < count` i współczynnikach `coeff`.
+ * @param start : najmniejszy wykładnik
+ * @param step : odstęp między wykładnikami
+ * @param count : liczba jednomianów
+ * @param coeff : współczynnik
+ * @return wielomian
+ */
+static Poly StridedPoly(poly_exp_t start, poly_exp_t step, unsigned count,
+                        poly_coeff_t coeff) {
+    Mono *monos = malloc(sizeof(Mono) * count);
+
+    for (unsigned k = 0; k < count; ++k) {
+        Poly c = PolyFromCoeff(coeff);
+        monos[k] = MonoFromPoly(&c, start + (poly_exp_t)k * step);
+    }
+
+    Poly result = PolyAddMonos(count, monos);
+    free(monos);
+
+    return result;
+}
+
+/**
+ * Test funkcji PolyAddMonos dla 300 jednomianów w losowej kolejności:
+ * każdy z wykładników od 0 do 99 występuje trzy razy, a część jednomianów ma
+ * zerowe współczynniki. Tablica jest dłuższa niż `MONO_SORT_INSERTION_MAX`,
+ * więc jest sortowana pozycyjnie.
+ * @param state : stan
+ */
+static void TestAddMonosShuffled(void **state) {
+    (void)state;
+
+    Mono monos[300];
+
+    for (unsigned k = 0; k < 300; ++k) {
+        Poly c = PolyFromCoeff((k < 200) ? 1 + (k / 100) : 0);
+        monos[k] = MonoFromPoly(&c, k % 100);
+    }
+
+    srand(17);
+
+    for (unsigned k = 299; k > 0; --k) {
+        unsigned j = rand() % (k + 1);
+        Mono tmp = monos[k];
+        monos[k] = monos[j];
+        monos[j] = tmp;
+    }
+
+    Poly res = PolyAddMonos(300, monos);
+    Poly expected = StridedPoly(0, 1, 100, 3);
+
+    assert_true(PolyIsEq(&expected, &res));
+    assert_int_equal(res.monos[0].exp, -1);
+
+    PolyDestroy(&res);
+    PolyDestroy(&expected);
+}
+
+/**
+ * Test akumulatora sumy: 300 jednomianów `x_0^k` dodanych po jednym przez
+ * AccAdd i jednomiany `-x_0^{2k}` dodane przez AccAddMonos muszą dać ten sam
+ * wynik co PolyAddMonos.
+ * @param state : stan
+ */
+static void TestAccumulatorMatchesAddMonos(void **state) {
+    (void)state;
+
+    PolyAccumulator acc = AccCreate();
+    Mono all[450];
+    Mono evens[150];
+
+    for (unsigned k = 0; k < 300; ++k) {
+        Poly one = PolyFromCoeff(1);
+        Mono m = MonoFromPoly(&one, k);
+        Poly p = PolyAddMonos(1, &m);
+        AccAdd(&acc, &p);
+        all[k] = MonoFromPoly(&one, k);
+    }
+
+    for (unsigned k = 0; k < 150; ++k) {
+        Poly minusOne = PolyFromCoeff(-1);
+        evens[k] = MonoFromPoly(&minusOne, 2 * k);
+        all[300 + k] = MonoFromPoly(&minusOne, 2 * k);
+    }
+
+    AccAddMonos(&acc, 150, evens);
+
+    Poly res = AccFinish(&acc);
+    Poly expected = PolyAddMonos(450, all);
+
+    assert_true(PolyIsEq(&expected, &res));
+    assert_int_equal(PolyTermCount(&res), 150);
+
+    Poly empty = AccFinish(&acc);
+    assert_true(PolyIsZero(&empty));
+
+    PolyDestroy(&res);
+    PolyDestroy(&expected);
+}
+
+/**
+ * Test tworzenia wielomianu z posortowanej tablicy jednomianów: wynik
+ * `PolyFromSortedMonosOwned` i `PolyAddMonosOwned` musi być równy wynikowi
+ * `PolyAddMonos`, także gdy stała przy `x_0^0` trafia do wyrazu wolnego.
+ * @param state : stan
+ */
+static void TestFromSortedMonos(void **state) {
+    (void)state;
+
+    // (x_1 + 7) + 3 x_0^2 + (x_1 + 7) x_0^5; stała 7 przy x_0^0 trafia do
+    // wyrazu wolnego całego wielomianu.
+    Mono inner[2];
+    Poly seven = PolyFromCoeff(7);
+    Poly one = PolyFromCoeff(1);
+    inner[0] = MonoFromPoly(&seven, 0);
+    inner[1] = MonoFromPoly(&one, 1);
+    Poly child = PolyAddMonos(2, inner);
+
+    Poly three = PolyFromCoeff(3);
+    Poly childCopy = PolyClone(&child);
+    Mono monos[3] = {MonoFromPoly(&child, 0), MonoFromPoly(&three, 2), MonoFromPoly(&childCopy, 5)};
+
+    Mono *sorted = PoolAlloc(sizeof(Mono) * 4);
+    Mono *shuffled = PoolAlloc(sizeof(Mono) * 4);
+
+    for (unsigned j = 0; j < 3; ++j) {
+        Poly copy = PolyClone(&monos[j].p);
+        sorted[j] = MonoFromPoly(&copy, monos[j].exp);
+        copy = PolyClone(&monos[j].p);
+        shuffled[2 - j] = MonoFromPoly(&copy, monos[j].exp);
+    }
+
+    Poly expected = PolyAddMonos(3, monos);
+    Poly fromSorted = PolyFromSortedMonosOwned(3, sorted);
+    Poly fromShuffled = PolyAddMonosOwned(3, shuffled);
+
+    assert_true(PolyIsEq(&expected, &fromSorted));
+    assert_true(PolyIsEq(&expected, &fromShuffled));
+    assert_int_equal(PolyTermCount(&fromSorted), PolyTermCount(&expected));
+
+    Poly empty = PolyFromSortedMonosOwned(0, NULL);
+    assert_true(PolyIsZero(&empty));
+
+    PolyDestroy(&expected);
+    PolyDestroy(&fromSorted);
+    PolyDestroy(&fromShuffled);
+}
+
+/**
+ * Test kopiowania przy zapisie: PolyClone nie alokuje pamięci, a operacje
+ * przejmujące na własność kopie nie zmieniają oryginału.
+ * @param state : stan
+ */
+static void TestCloneCopyOnWrite(void **state) {
+    (void)state;
+
+    const unsigned depth = 20;
+    poly_coeff_t ones[20];
+
+    for (unsigned j = 0; j < depth; ++j) {
+        ones[j] = 1;
+    }
+
+    Poly p = DeepChainPoly(depth);
+
+    size_t allocCount = PolyAllocCount();
+    Poly c1 = PolyClone(&p);
+    Poly c2 = PolyClone(&p);
+    assert_int_equal(PolyAllocCount(), allocCount);
+    assert_true(PolyIsEq(&p, &c1));
+
+    Poly doubled = PolyAddOwned(&c1, &c2);
+    assert_int_equal(PolyEvalAll(&doubled, depth, ones), 2 * (depth + 1));
+    assert_int_equal(PolyEvalAll(&p, depth, ones), depth + 1);
+
+    Poly c3 = PolyClone(&p);
+    Poly c4 = PolyClone(&p);
+    Poly zero = PolySubOwned(&c3, &c4);
+    assert_true(PolyIsZero(&zero));
+    assert_int_equal(PolyEvalAll(&p, depth, ones), depth + 1);
+
+    PolyDestroy(&p);
+    PolyDestroy(&doubled);
+}
+
+/**
+ * Test trybu internowania: równe wielomiany na stosie współdzielą węzły,
+ * a HASH_STATS wypisuje liczbę węzłów i współczynnik deduplikacji.
+ * @param state : stan
+ */
+static void TestHashConsCommand(void **state) {
+    (void)state;
+
+    init_input_stream("((1,1),2)+(3,1)\nHASH_CONS\n((1,1),2)+(3,1)\nIS_EQ\nNEG\nIS_EQ\n"
+                      "NEG\nIS_EQ\nHASH_STATS\n");
+    assert_int_equal(mock_main(), 0);
+    assert_string_equal(printf_buffer, "1\n0\n1\nnodes 2 lookups 8 hits 4 ratio 2.00\n");
+    assert_string_equal(fprintf_buffer, "");
+    assert_false(PolyHashConsEnabled());
+}
+
+/**
+ * Test funkcji PolyAt dla `p = x_0^2 * x_1 + 3 * x_0 + x_1` w punktach 2 i 0.
+ * Sprawdza sumowanie współczynników stałych i niestałych przy tym samym
+ * wykładniku wyniku.
+ * @param state : stan
+ */
+static void TestAtMixedCoeffs(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly three = PolyFromCoeff(3);
+    Poly five = PolyFromCoeff(5);
+    Poly six = PolyFromCoeff(6);
+    Mono x1Monos[1] = {MonoFromPoly(&one, 1)};
+    Poly x1 = PolyAddMonos(1, x1Monos);
+    Poly x1Copy = PolyClone(&x1);
+    Poly x1Expected = PolyClone(&x1);
+    Mono pMonos[3] = {MonoFromPoly(&x1, 2), MonoFromPoly(&three, 1), MonoFromPoly(&x1Copy, 0)};
+    Mono expectedMonos[2] = {MonoFromPoly(&five, 1), MonoFromPoly(&six, 0)};
+    Poly p = PolyAddMonos(3, pMonos);
+    Poly expectedRes = PolyAddMonos(2, expectedMonos);
+
+    Poly res = PolyAt(&p, 2);
+    assert_true(PolyIsEq(&expectedRes, &res));
+    PolyDestroy(&res);
+
+    res = PolyAt(&p, 0);
+    assert_true(PolyIsEq(&x1Expected, &res));
+    PolyDestroy(&res);
+
+    PolyDestroy(&p);
+    PolyDestroy(&expectedRes);
+    PolyDestroy(&x1Expected);
+}
+
+/**
+ * Test funkcji PolyAtMany dla gęstego wielomianu jednej zmiennej stopnia 299
+ * w 600 punktach, które przechodzą przez drzewo iloczynów. Wyniki porównuje
+ * z wynikami funkcji PolyAt.
+ * @param state : stan
+ */
+static void TestAtManyMatchesAt(void **state) {
+    (void)state;
+
+    const unsigned size = 300, count = 600;
+    Mono *monos = malloc(sizeof(Mono) * size);
+    poly_coeff_t *x = malloc(sizeof(poly_coeff_t) * count);
+    Poly *out = malloc(sizeof(Poly) * count);
+    assert_non_null(monos);
+    assert_non_null(x);
+    assert_non_null(out);
+
+    for (unsigned j = 0; j < size; ++j) {
+        Poly c = PolyFromCoeff((poly_coeff_t)(j * 7919 % 201) - 100);
+        monos[j] = MonoFromPoly(&c, j);
+    }
+
+    for (unsigned j = 0; j < count; ++j) {
+        x[j] = (poly_coeff_t)j * 1000003 - 300000000;
+    }
+
+    Poly p = PolyAddMonos(size, monos);
+    PolyAtMany(&p, count, x, out);
+
+    for (unsigned j = 0; j < count; ++j) {
+        Poly expectedRes = PolyAt(&p, x[j]);
+        assert_true(PolyIsEq(&expectedRes, &out[j]));
+        PolyDestroy(&expectedRes);
+        PolyDestroy(&out[j]);
+    }
+
+    PolyDestroy(&p);
+    free(monos);
+    free(x);
+    free(out);
+}
+
+/**
+ * Test zamrażania wielomianu `x_1 * x_0^2 + 3 * x_0 + x_1 + 7`: odtworzony
+ * wielomian, kopia bloku, stopnie, wartości w punktach i wypisywanie muszą
+ * zgadzać się z wynikami dla zwykłego wielomianu.
+ * @param state : stan
+ */
+static void TestFreezeMatchesPoly(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly three = PolyFromCoeff(3);
+    Poly seven = PolyFromCoeff(7);
+    Mono x1Monos[1] = {MonoFromPoly(&one, 1)};
+    Poly x1 = PolyAddMonos(1, x1Monos);
+    Poly x1Copy = PolyClone(&x1);
+    Mono pMonos[4] = {MonoFromPoly(&x1, 2), MonoFromPoly(&three, 1),
+                      MonoFromPoly(&x1Copy, 0), MonoFromPoly(&seven, 0)};
+    Poly p = PolyAddMonos(4, pMonos);
+
+    FrozenPoly *f = PolyFreeze(&p);
+    FrozenPoly *copy = malloc(FrozenBytes(f));
+    memcpy(copy, f, FrozenBytes(f));
+    assert_true(FrozenIsEq(f, copy));
+
+    Poly thawed = PolyThaw(copy);
+    assert_true(PolyIsEq(&p, &thawed));
+    assert_int_equal(FrozenDeg(f), PolyDeg(&p));
+
+    for (unsigned var = 0; var < 3; ++var) {
+        assert_int_equal(FrozenDegBy(f, var), PolyDegBy(&p, var));
+    }
+
+    for (poly_coeff_t x = -2; x <= 2; ++x) {
+        Poly expected = PolyAt(&p, x);
+        Poly res = FrozenAt(f, x);
+        assert_true(PolyIsEq(&expected, &res));
+        PolyDestroy(&expected);
+        PolyDestroy(&res);
+    }
+
+    PolyPrint(&p);
+    char expected[sizeof(printf_buffer)];
+    strcpy(expected, printf_buffer);
+    printf_position = 0;
+    FrozenPrint(f);
+    assert_string_equal(printf_buffer, expected);
+
+    Poly zero = PolyZero();
+    FrozenPoly *z = PolyFreeze(&zero);
+    assert_false(FrozenIsEq(f, z));
+    assert_int_equal(FrozenDeg(z), -1);
+
+    FrozenDestroy(f);
+    FrozenDestroy(z);
+    free(copy);
+    PolyDestroy(&p);
+    PolyDestroy(&thawed);
+}
+
+/**
+ * Test polecenia AT_MANY: wyniki trafiają na stos tak, że na wierzchołku
+ * jest wartość w pierwszym punkcie, a brakujący punkt daje błąd.
+ * @param state : stan
+ */
+static void TestAtManyCommand(void **state) {
+    (void)state;
+
+    init_input_stream("(1,2)+(1,0)\nAT_MANY 3 0 1 -2\nPRINT\nPOP\nPRINT\nPOP\nPRINT\n"
+                      "AT_MANY 2 1\n");
+    assert_int_equal(mock_main(), 0);
+    assert_string_equal(printf_buffer, "1\n2\n5\n");
+    assert_string_equal(fprintf_buffer, "ERROR 8 WRONG VALUE\n");
+}
+
+/**
+ * Test funkcji PolyEvalAll dla `p = x_0^2 * x_1 + 3 * x_0 + x_1`.
+ * Zmienne, dla których nie podano wartości, są zerowane.
+ * @param state : stan
+ */
+static void TestEvalAll(void **state) {
+    (void)state;
+
+    Poly one = PolyFromCoeff(1);
+    Poly three = PolyFromCoeff(3);
+    Mono x1Monos[1] = {MonoFromPoly(&one, 1)};
+    Poly x1 = PolyAddMonos(1, x1Monos);
+    Poly x1Copy = PolyClone(&x1);
+    Mono pMonos[3] = {MonoFromPoly(&x1, 2), MonoFromPoly(&three, 1), MonoFromPoly(&x1Copy, 0)};
+    Poly p = PolyAddMonos(3, pMonos);
+    const poly_coeff_t vals[2] = {2, 5};
+
+    assert_int_equal(PolyEvalAll(&p, 2, vals), 31);
+    assert_int_equal(PolyEvalAll(&p, 1, vals), 6);
+    assert_int_equal(PolyEvalAll(&p, 0, vals), 0);
+
+    PolyDestroy(&p);
+}
+
+/**
+ * Test polecenia AT_VARS, w tym błędu przy brakującej wartości.
+ * @param state : stan
+ */
+static void TestAtVarsCommand(void **state) {
+    (void)state;
+
+    init_input_stream("((1,1),2)+(3,1)+((1,1),0)\nAT_VARS 2 2 5\nPRINT\nAT_VARS 1\n");
+    assert_int_equal(mock_main(), 0);
+    assert_string_equal(printf_buffer, "31\n");
+    assert_string_equal(fprintf_buffer, "ERROR 4 WRONG VALUE\n");
+}
+
+/**
+ * Test polecenia DEGS i zapamiętanych stopni: dodawanie w miejscu do
+ * wielomianu, którego stopnie były już wyliczone, musi je unieważnić.
+ * @param state : stan
+ */
+static void TestDegsCommand(void **state) {
+    (void)state;
+
+    init_input_stream("((1,2)+(1,0),3)+(2,1)\nDEGS\nDEG\nCLONE\n((1,4),3)\nADD\nDEGS\nDEG\n"
+                      "(1,5)\nADD\nDEGS\nIS_EQ\n5\nDEGS\nZERO\nDEGS\nDEGS 1\nDEGSS\n");
+    assert_int_equal(mock_main(), 0);
+    assert_string_equal(printf_buffer, "3 2\n5\n3 4\n7\n5 4\n0\n0\n-1\n");
+    assert_string_equal(fprintf_buffer, "ERROR 17 WRONG COMMAND\nERROR 18 WRONG COMMAND\n");
+}
+
+/**
+ * Test areny: pamięć przydzielona po zapamiętaniu znacznika jest zwalniana
+ * przez ArenaRestore, a wcześniejsza pamięć zostaje nienaruszona.
+ * @param state : stan
+ */
+static void TestArenaRestore(void **state) {
+    (void)state;
+
+    AllocStats before = AllocGetStats();
+    ArenaMark outer = ArenaSave();
+    poly_coeff_t *kept = ArenaAlloc(sizeof(poly_coeff_t) * 4);
+    kept[3] = 42;
+
+    ArenaMark inner = ArenaSave();
+
+    for (unsigned j = 0; j < 8; ++j) {
+        poly_coeff_t *tmp = ArenaAlloc(ARENA_CHUNK_SIZE / 4);
+        memset(tmp, 0xff, ARENA_CHUNK_SIZE / 4);
+    }
+
+    ArenaRestore(inner);
+    assert_int_equal(kept[3], 42);
+
+    AllocStats after = AllocGetStats();
+    assert_int_equal(after.arenaAllocs - before.arenaAllocs, 9);
+    assert_true(after.arenaPeak >= 2 * ARENA_CHUNK_SIZE);
+
+    ArenaRestore(outer);
+}
+
+/**
+ * Test puli: zmiana rozmiaru bloku zachowuje zawartość, a każdy blok jest
+ * zwracany dokładnie raz.
+ * @param state : stan
+ */
+static void TestPoolRealloc(void **state) {
+    (void)state;
+
+    AllocStats before = AllocGetStats();
+    unsigned *block = PoolAlloc(sizeof(unsigned) * 4);
+
+    for (unsigned j = 0; j < 4; ++j) {
+        block[j] = j;
+    }
+
+    block = PoolRealloc(block, sizeof(unsigned) * 1000);
+
+    for (unsigned j = 0; j < 4; ++j) {
+        assert_int_equal(block[j], j);
+    }
+
+    block = PoolRealloc(block, sizeof(unsigned) * 2);
+    assert_int_equal(block[1], 1);
+    PoolFree(block);
+
+    AllocStats after = AllocGetStats();
+    assert_int_equal(after.poolAllocs - before.poolAllocs,
+                     after.poolFrees - before.poolFrees);
+}
+
 int main(void) {
     const struct CMUnitTest PolyComposeFunctionTests[] = {
             cmocka_unit_test(TestComposeZeroZero),
@@ -387,7 +1226,8 @@ int main(void) {
             cmocka_unit_test(TestComposeConstConst),
             cmocka_unit_test(TestComposeIdentityZero),
             cmocka_unit_test(TestComposeIdentityConst),
-            cmocka_unit_test(TestComposeIdentityIdentity)
+            cmocka_unit_test(TestComposeIdentityIdentity),
+            cmocka_unit_test(TestComposePowers)
     };
 
     const struct CMUnitTest PolyComposeParseTests[] = {
@@ -398,8 +1238,53 @@ int main(void) {
             cmocka_unit_test_setup(TestComposeParameterTooBig, test_setup),
             cmocka_unit_test_setup(TestComposeParameterLarge, test_setup),
             cmocka_unit_test_setup(TestComposeParameterLetters, test_setup),
-            cmocka_unit_test_setup(TestComposeParameterAlphanumeric, test_setup)
+            cmocka_unit_test_setup(TestComposeParameterAlphanumeric, test_setup),
+            cmocka_unit_test_setup(TestParseNumberLimits, test_setup),
+            cmocka_unit_test_setup(TestParseCommandPrefixes, test_setup)
+    };
+
+    const struct CMUnitTest PolyMulFunctionTests[] = {
+            cmocka_unit_test(TestMulDifferenceOfSquares),
+            cmocka_unit_test(TestMulMultivariate),
+            cmocka_unit_test(TestMulDense),
+            cmocka_unit_test(TestMulNtt),
+            cmocka_unit_test(TestMulKronecker)
+    };
+
+    const struct CMUnitTest PolyAddFunctionTests[] = {
+            cmocka_unit_test(TestAddOwnedCancellation),
+            cmocka_unit_test(TestAddMonosCancelToCoeff),
+            cmocka_unit_test(TestAddDeepAllocCount),
+            cmocka_unit_test(TestScalarMulAllocCount),
+            cmocka_unit_test(TestAddMonosShuffled),
+            cmocka_unit_test(TestAccumulatorMatchesAddMonos),
+            cmocka_unit_test(TestFromSortedMonos),
+            cmocka_unit_test(TestCloneCopyOnWrite),
+            cmocka_unit_test_setup(TestHashConsCommand, test_setup)
+    };
+
+    const struct CMUnitTest PolyAtFunctionTests[] = {
+            cmocka_unit_test(TestAtMixedCoeffs),
+            cmocka_unit_test(TestAtManyMatchesAt),
+            cmocka_unit_test_setup(TestAtManyCommand, test_setup),
+            cmocka_unit_test(TestEvalAll),
+            cmocka_unit_test_setup(TestFreezeMatchesPoly, test_setup),
+            cmocka_unit_test_setup(TestAtVarsCommand, test_setup)
+    };
+
+    const struct CMUnitTest PolyDegFunctionTests[] = {
+            cmocka_unit_test_setup(TestDegsCommand, test_setup)
+    };
+
+    const struct CMUnitTest AllocatorTests[] = {
+            cmocka_unit_test(TestArenaRestore),
+            cmocka_unit_test(TestPoolRealloc)
     };
 
-    return cmocka_run_group_tests(PolyComposeFunctionTests, NULL, NULL) || cmocka_run_group_tests(PolyComposeParseTests, NULL, NULL);
+    return cmocka_run_group_tests(PolyComposeFunctionTests, NULL, NULL) || cmocka_run_group_tests(PolyComposeParseTests, NULL, NULL)
+           || cmocka_run_group_tests(PolyMulFunctionTests, NULL, NULL)
+           || cmocka_run_group_tests(PolyAddFunctionTests, NULL, NULL)
+           || cmocka_run_group_tests(PolyAtFunctionTests, NULL, NULL)
+           || cmocka_run_group_tests(PolyDegFunctionTests, NULL, NULL)
+           || cmocka_run_group_tests(AllocatorTests, NULL, NULL);
 }
\ No newline at end of file
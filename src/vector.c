@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include "allocator.h"
 #include "poly.h"
 #include "utils.h"
 
@@ -22,6 +23,7 @@ typedef struct Vector {
     Mono* monos; ///< tablica jednomianów
     unsigned size; ///< liczba jednomianów w tablicy monos
     unsigned maxSize; ///< faktyczny rozmiar tablicy monos
+    bool sorted; ///< czy jednomiany mają ściśle rosnące wykładniki i niezerowe współczynniki
 } Vector;
 
 /**
@@ -29,7 +31,7 @@ typedef struct Vector {
  * @return pusty wektor
  */
 Vector VectorCreate() {
-    return (Vector) {.monos = NULL, .size = 0, .maxSize = 1};
+    return (Vector) {.monos = NULL, .size = 0, .maxSize = 1, .sorted = true};
 }
 
 /**
@@ -48,28 +50,35 @@ static inline bool VectorIsEmpty(const Vector *v) {
  * @param[in] m : jednomian
  */
 void VectorAddMono(Vector *v, Mono m) {
-    if (VectorIsEmpty(v)) {
-        v->monos = malloc(sizeof(Mono));
-        assert(v->monos != NULL);
+    // Literały zwykle podają jednomiany w kolejności rosnących wykładników;
+    // wtedy wielomian powstaje z tablicy wektora bez sortowania i sumowania.
+    v->sorted = v->sorted && !PolyIsZero(&m.p)
+                && (VectorIsEmpty(v) || v->monos[v->size - 1].exp < m.exp);
 
-        v->monos[0] = m;
+    if (VectorIsEmpty(v)) {
+        v->monos = PoolAlloc(sizeof(Mono));
     } else if (v->size == v->maxSize) {
         v->maxSize *= 2;
-        Mono *newMonos = malloc(sizeof(Mono) * v->maxSize);
-        assert(newMonos != NULL);
+        v->monos = PoolRealloc(v->monos, sizeof(Mono) * v->maxSize);
+    }
 
-        for (unsigned j = 0; j < v->size; ++j) {
-            newMonos[j] = v->monos[j];
-        }
+    v->monos[v->size] = m;
+
+    v->size++;
+}
 
-        newMonos[v->size] = m;
-        free(v->monos);
-        v->monos = newMonos;
+/**
+ * Tworzy wielomian będący sumą jednomianów wektora @p v, przejmując na
+ * własność jego tablicę jednomianów.
+ * @param[in] v : wektor
+ * @return wielomian
+ */
+static Poly VectorToPoly(Vector *v) {
+    if (v->sorted) {
+        return PolyFromSortedMonosOwned(v->size, v->monos);
     } else {
-        v->monos[v->size] = m;
+        return PolyAddMonosOwned(v->size, v->monos);
     }
-
-    v->size++;
 }
 
 /**
@@ -82,7 +91,7 @@ void ClearVector(Vector *v) {
             MonoDestroy(&v->monos[j]);
         }
 
-        free(v->monos);
+        PoolFree(v->monos);
     }
 }
 
@@ -100,33 +109,23 @@ typedef struct ParseVector {
 
 /**
  * Wektor wektorów jednomianów, na którym odbywaja się wszystkie obliczenia
- * w module `vector`.
+ * w module `vector`; każdy wątek parsujący wielomiany ma własny.
  */
-ParseVector PV;
+_Thread_local ParseVector PV;
 
 void ParseVectorInit() {
-    PV = (ParseVector) {.vectors = malloc(sizeof(Vector)), .size = 1, .maxSize = 1};
-    assert(PV.vectors != NULL);
+    PV = (ParseVector) {.vectors = PoolAlloc(sizeof(Vector)), .size = 1, .maxSize = 1};
     PV.vectors[0] = VectorCreate();
 }
 
 void ParseVectorNewLayer() {
     if (PV.size == PV.maxSize) {
         PV.maxSize *= 2;
-        Vector *newVectors = malloc(sizeof(Vector) * PV.maxSize);
-        assert(newVectors != NULL);
-
-        for (unsigned j = 0; j < PV.size; ++j) {
-            newVectors[j] = PV.vectors[j];
-        }
-
-        newVectors[PV.size] = VectorCreate();
-        free(PV.vectors);
-        PV.vectors = newVectors;
-    } else {
-        PV.vectors[PV.size] = VectorCreate();
+        PV.vectors = PoolRealloc(PV.vectors, sizeof(Vector) * PV.maxSize);
     }
 
+    PV.vectors[PV.size] = VectorCreate();
+
     PV.size++;
 }
 
@@ -141,9 +140,7 @@ void ParseVectorPolyAddMonos(poly_coeff_t coeff, poly_exp_t e) {
         Poly p = PolyFromCoeff(coeff);
         m = MonoFromPoly(&p, e);
     } else {
-        Poly p = PolyAddMonos(PV.vectors[PV.size - 1].size, PV.vectors[PV.size - 1].monos);
-        free(PV.vectors[PV.size - 1].monos);
-
+        Poly p = VectorToPoly(&PV.vectors[PV.size - 1]);
         m = MonoFromPoly(&p, e);
     }
 
@@ -152,16 +149,8 @@ void ParseVectorPolyAddMonos(poly_coeff_t coeff, poly_exp_t e) {
     ParseVectorAddMono(m);
 
     if (PV.size <= PV.maxSize / 4) {
-        Vector *newVectors = malloc(sizeof(Vector) * (PV.maxSize / 2));
-        assert(newVectors != NULL);
-
-        for (unsigned j = 0; j < PV.size; ++j) {
-            newVectors[j] = PV.vectors[j];
-        }
-
-        free(PV.vectors);
-        PV.vectors = newVectors;
         PV.maxSize /= 2;
+        PV.vectors = PoolRealloc(PV.vectors, sizeof(Vector) * PV.maxSize);
     }
 }
 
@@ -171,17 +160,16 @@ void ParseVectorClear() {
             ClearVector(&PV.vectors[j]);
         }
 
-        free(PV.vectors);
+        PoolFree(PV.vectors);
     }
 }
 
 Poly ParseVectorResult() {
     assert(PV.size == 1);
 
-    Poly p = PolyAddMonos(PV.vectors[0].size, PV.vectors[0].monos);
+    Poly p = VectorToPoly(&PV.vectors[0]);
 
-    free(PV.vectors[0].monos);
-    free(PV.vectors);
+    PoolFree(PV.vectors);
 
     PV.size = 0;
 